@@ -22,6 +22,7 @@ static const int
         insertTrack = 0x30000,
         insertProcessorLane = 0x30001,
         createMasterTrack = 0x30002,
+        freezeTrack = 0x30003,
         showPush2MirrorWindow = 0x40000,
         navigateLeft = 0x40001,
         navigateRight = 0x40002,
@@ -1,23 +1,50 @@
 #pragma once
 
-class DeviceChangeMonitor : private Timer {
+// Looks for MIDI devices coming and going every second, on a background thread (enumerating them can be slow),
+// and tells the device manager's listeners once on the message thread, however many devices changed.
+class DeviceChangeMonitor : private Thread, private AsyncUpdater {
 public:
-    explicit DeviceChangeMonitor(AudioDeviceManager &audioDeviceManager) : audioDeviceManager(audioDeviceManager) {
-        startTimer(1000);
+    explicit DeviceChangeMonitor(AudioDeviceManager &audioDeviceManager)
+            : Thread("Device change monitor"), audioDeviceManager(audioDeviceManager) {
+        startThread();
+    }
+
+    ~DeviceChangeMonitor() override {
+        stopThread(2000);
+        cancelPendingUpdate();
     }
 
 private:
+    static constexpr int CHECK_INTERVAL_MS = 1000;
+
     AudioDeviceManager &audioDeviceManager;
-    int numInputDevices{0}, numOutputDevices{0};
+    // Only accessed by the monitor thread.
+    StringArray inputDeviceIdentifiers, outputDeviceIdentifiers;
 
-    void timerCallback() override {
-        int newNumInputDevices = MidiInput::getDevices().size();
-        int newNumOutputDevices = MidiOutput::getDevices().size();
+    static StringArray getSortedIdentifiers(const Array<MidiDeviceInfo> &devices) {
+        StringArray identifiers;
+        for (const auto &device : devices)
+            identifiers.add(device.identifier);
+        identifiers.sort(false);
+        return identifiers;
+    }
 
-        if (numInputDevices != newNumInputDevices || numOutputDevices != newNumOutputDevices)
-            audioDeviceManager.sendChangeMessage();
+    void run() override {
+        // Starting with no devices, so the ones already there when it starts are announced too.
+        while (!threadShouldExit()) {
+            wait(CHECK_INTERVAL_MS);
+            if (threadShouldExit()) return;
 
-        numInputDevices = newNumInputDevices;
-        numOutputDevices = newNumOutputDevices;
+            auto newInputDeviceIdentifiers = getSortedIdentifiers(MidiInput::getAvailableDevices());
+            auto newOutputDeviceIdentifiers = getSortedIdentifiers(MidiOutput::getAvailableDevices());
+            // Compared by identity, so a device being swapped for another one is a change too.
+            if (newInputDeviceIdentifiers != inputDeviceIdentifiers || newOutputDeviceIdentifiers != outputDeviceIdentifiers) {
+                inputDeviceIdentifiers.swapWith(newInputDeviceIdentifiers);
+                outputDeviceIdentifiers.swapWith(newOutputDeviceIdentifiers);
+                triggerAsyncUpdate();
+            }
+        }
     }
+
+    void handleAsyncUpdate() override { audioDeviceManager.sendChangeMessage(); }
 };
@@ -0,0 +1,452 @@
+#include "GraphRenderSequence.h"
+
+#include <deque>
+#include <unordered_map>
+
+using Connection = AudioProcessorGraph::Connection;
+using AudioGraphIOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+
+struct GraphRenderSequence::DelayLine {
+    DelayLine(int delaySamples, int blockSize) : buffer((size_t) delaySamples, 0.0f), output((size_t) blockSize, 0.0f) {}
+
+    const float *process(const float *input, int numSamples) {
+        for (int i = 0; i < numSamples; i++) {
+            output[(size_t) i] = buffer[position];
+            buffer[position] = input[i];
+            if (++position == buffer.size()) position = 0;
+        }
+        return output.data();
+    }
+
+private:
+    std::vector<float> buffer, output;
+    size_t position{0};
+};
+
+GraphRenderSequence::GraphRenderSequence(const AudioProcessorGraph &graph, int blockSize) : blockSize(jmax(1, blockSize)) {
+    compile(graph);
+}
+
+GraphRenderSequence::~GraphRenderSequence() = default;
+
+static bool isFusableGainStage(const AudioProcessor *processor, bool isFirstStage) {
+    return dynamic_cast<const GainStageProcessor *>(processor) != nullptr && processor->getLatencySamples() == 0 &&
+           processor->getTotalNumOutputChannels() == 2 &&
+           (isFirstStage ? processor->getTotalNumInputChannels() <= 2 : processor->getTotalNumInputChannels() == 2);
+}
+
+// The gain stage that the gain stage at `nodeIndex` can be fused with: the only node it feeds, if it feeds that node
+// its left & right channels (and maybe its MIDI) straight through, and that node gets nothing from anywhere else.
+static int findFusableNextStage(int nodeIndex, const ReferenceCountedArray<AudioProcessorGraph::Node> &nodes,
+                                const std::vector<std::vector<Connection>> &incoming, const std::vector<std::vector<Connection>> &outgoing,
+                                const std::unordered_map<uint32, int> &nodeIndexForId, const std::vector<int> &stepIndexForNode,
+                                bool &receivesMidi) {
+    auto *gainStage = dynamic_cast<GainStageProcessor *>(nodes.getUnchecked(nodeIndex)->getProcessor());
+    // A metered stage needs the audio as it leaves it, so it can only end a chain.
+    if (gainStage == nullptr || gainStage->getStageMeterSource() != nullptr) return -1;
+
+    const auto &connections = outgoing[(size_t) nodeIndex];
+    if (connections.empty()) return -1;
+
+    const auto nextNodeId = connections.front().destination.nodeID;
+    const int nextIndex = nodeIndexForId.at(nextNodeId.uid);
+    if (stepIndexForNode[(size_t) nextIndex] != -1 || !isFusableGainStage(nodes.getUnchecked(nextIndex)->getProcessor(), false) ||
+        incoming[(size_t) nextIndex].size() != connections.size())
+        return -1;
+
+    bool hasLeft = false, hasRight = false;
+    receivesMidi = false;
+    for (const auto &connection : connections) {
+        if (connection.destination.nodeID != nextNodeId) return -1;
+
+        if (connection.source.isMIDI())
+            receivesMidi = true;
+        else if (connection.source.channelIndex == 0 && connection.destination.channelIndex == 0)
+            hasLeft = true;
+        else if (connection.source.channelIndex == 1 && connection.destination.channelIndex == 1)
+            hasRight = true;
+        else
+            return -1;
+    }
+    return hasLeft && hasRight ? nextIndex : -1;
+}
+
+void GraphRenderSequence::compile(const AudioProcessorGraph &graph) {
+    const auto &nodes = graph.getNodes();
+    const auto numNodes = (size_t) nodes.size();
+
+    std::unordered_map<uint32, int> nodeIndexForId;
+    for (int i = 0; i < nodes.size(); i++)
+        nodeIndexForId[nodes.getUnchecked(i)->nodeID.uid] = i;
+
+    std::vector<std::vector<Connection>> incoming(numNodes), outgoing(numNodes);
+    for (const auto &connection : graph.getConnections()) {
+        const auto source = nodeIndexForId.find(connection.source.nodeID.uid);
+        const auto destination = nodeIndexForId.find(connection.destination.nodeID.uid);
+        if (source == nodeIndexForId.end() || destination == nodeIndexForId.end()) continue;
+
+        outgoing[(size_t) source->second].push_back(connection);
+        incoming[(size_t) destination->second].push_back(connection);
+    }
+
+    // Topological order, keeping the graph's own node order wherever there's a choice (but with graph inputs first).
+    std::vector<int> order;
+    std::vector<size_t> numPendingInputs(numNodes);
+    std::deque<int> ready;
+    for (size_t i = 0; i < numNodes; i++) {
+        numPendingInputs[i] = incoming[i].size();
+        if (numPendingInputs[i] == 0) {
+            auto *ioProcessor = dynamic_cast<AudioGraphIOProcessor *>(nodes.getUnchecked((int) i)->getProcessor());
+            if (ioProcessor != nullptr && ioProcessor->isInput())
+                ready.push_front((int) i);
+            else
+                ready.push_back((int) i);
+        }
+    }
+    while (!ready.empty()) {
+        const int nodeIndex = ready.front();
+        ready.pop_front();
+        order.push_back(nodeIndex);
+        for (const auto &connection : outgoing[(size_t) nodeIndex]) {
+            const int destinationIndex = nodeIndexForId[connection.destination.nodeID.uid];
+            if (--numPendingInputs[(size_t) destinationIndex] == 0) ready.push_back(destinationIndex);
+        }
+    }
+    // Nodes in feedback loops. Their inputs from later in the sequence are left unconnected.
+    for (size_t i = 0; i < numNodes; i++)
+        if (numPendingInputs[i] > 0)
+            order.push_back((int) i);
+
+    std::vector<int> stepIndexForNode(numNodes, -1);
+    for (const int nodeIndex : order) {
+        if (stepIndexForNode[(size_t) nodeIndex] != -1) continue; // Already fused into an earlier step.
+
+        const int stepIndex = (int) steps.size();
+        auto step = std::make_unique<Step>();
+        auto *node = nodes.getUnchecked(nodeIndex);
+        auto *processor = node->getProcessor();
+        step->nodes.push_back(node);
+        stepIndexForNode[(size_t) nodeIndex] = stepIndex;
+
+        int numInputChannels = processor->getTotalNumInputChannels();
+        step->numOutputChannels = processor->getTotalNumOutputChannels();
+        step->numChannels = jmax(numInputChannels, step->numOutputChannels);
+        int processorLatencySamples = processor->getLatencySamples();
+        if (auto *ioProcessor = dynamic_cast<AudioGraphIOProcessor *>(processor)) {
+            processorLatencySamples = 0;
+            switch (ioProcessor->getType()) {
+                case AudioGraphIOProcessor::audioInputNode:
+                    step->type = Step::audioInput;
+                    numInputChannels = 0;
+                    step->numChannels = step->numOutputChannels;
+                    break;
+                case AudioGraphIOProcessor::audioOutputNode:
+                    step->type = Step::audioOutput;
+                    step->numChannels = step->numOutputChannels = 0;
+                    break;
+                case AudioGraphIOProcessor::midiInputNode:
+                    step->type = Step::midiInput;
+                    numInputChannels = step->numChannels = step->numOutputChannels = 0;
+                    break;
+                case AudioGraphIOProcessor::midiOutputNode:
+                    step->type = Step::midiOutput;
+                    numInputChannels = step->numChannels = step->numOutputChannels = 0;
+                    break;
+            }
+            if (ioProcessor->isInput()) numInputSteps++;
+        } else if (isFusableGainStage(processor, true)) {
+            bool receivesMidi = false;
+            for (int stageIndex = findFusableNextStage(nodeIndex, nodes, incoming, outgoing, nodeIndexForId, stepIndexForNode, receivesMidi);
+                 stageIndex != -1;
+                 stageIndex = findFusableNextStage(stageIndex, nodes, incoming, outgoing, nodeIndexForId, stepIndexForNode, receivesMidi)) {
+                step->nodes.push_back(nodes.getUnchecked(stageIndex));
+                step->gainStageReceivesMidi.push_back(receivesMidi);
+                stepIndexForNode[(size_t) stageIndex] = stepIndex;
+            }
+            if (step->nodes.size() > 1) {
+                step->type = Step::fusedGainStages;
+                step->gainStageReceivesMidi.insert(step->gainStageReceivesMidi.begin(), true);
+                for (const auto &stageNode : step->nodes)
+                    step->gainStages.push_back(dynamic_cast<GainStageProcessor *>(stageNode->getProcessor()));
+            }
+        }
+
+        // Inputs of the first node. (Any others in a fused chain only get their inputs from within the chain.)
+        step->audioInputs.resize((size_t) numInputChannels);
+        for (const auto &connection : incoming[(size_t) nodeIndex]) {
+            const int sourceStepIndex = stepIndexForNode[(size_t) nodeIndexForId[connection.source.nodeID.uid]];
+            if (sourceStepIndex == -1 || sourceStepIndex == stepIndex) continue; // Feedback
+
+            if (connection.source.isMIDI()) {
+                if (std::find(step->midiInputStepIndices.begin(), step->midiInputStepIndices.end(), sourceStepIndex) == step->midiInputStepIndices.end())
+                    step->midiInputStepIndices.push_back(sourceStepIndex);
+            } else if (connection.destination.channelIndex < numInputChannels &&
+                       connection.source.channelIndex < steps[(size_t) sourceStepIndex]->numOutputChannels) {
+                step->audioInputs[(size_t) connection.destination.channelIndex].push_back({sourceStepIndex, connection.source.channelIndex, nullptr});
+            }
+        }
+
+        // Latency compensation: delay every audio input to line up with the latest one.
+        int inputLatencySamples = 0;
+        for (const auto &channelInputs : step->audioInputs)
+            for (const auto &input : channelInputs)
+                inputLatencySamples = jmax(inputLatencySamples, steps[(size_t) input.stepIndex]->latencySamples);
+        for (auto &channelInputs : step->audioInputs) {
+            for (auto &input : channelInputs) {
+                const int delaySamples = inputLatencySamples - steps[(size_t) input.stepIndex]->latencySamples;
+                if (delaySamples > 0) {
+                    delayLines.push_back(std::make_unique<DelayLine>(delaySamples, blockSize));
+                    input.delay = delayLines.back().get();
+                }
+            }
+        }
+        step->latencySamples = inputLatencySamples + processorLatencySamples;
+        if (step->type == Step::audioOutput) {
+            latencySamples = jmax(latencySamples, inputLatencySamples);
+            step->addsToGraphOutput.resize((size_t) numInputChannels);
+            isGraphOutputChannelWritten.resize(jmax(isGraphOutputChannelWritten.size(), (size_t) numInputChannels));
+            for (size_t channel = 0; channel < (size_t) numInputChannels; channel++) {
+                step->addsToGraphOutput[channel] = isGraphOutputChannelWritten[channel];
+                if (!step->audioInputs[channel].empty())
+                    isGraphOutputChannelWritten[channel] = true;
+            }
+        }
+
+        step->midi.ensureSize(2048);
+        steps.push_back(std::move(step));
+    }
+    jassert(std::all_of(steps.begin(), steps.begin() + (std::ptrdiff_t) numInputSteps, [](const auto &step) { return step->type == Step::audioInput || step->type == Step::midiInput; }));
+
+    allocateBuffers();
+    graphOutputMidi.ensureSize(2048);
+    chunkMidi.ensureSize(2048);
+}
+
+// Liveness analysis over the (already ordered) steps: a channel's buffer is taken from the pool right before
+// its step, and handed back right after the last step reading it. Most recently freed buffers are reused first.
+void GraphRenderSequence::allocateBuffers() {
+    std::vector<std::vector<int>> numPendingReads(steps.size());
+    std::vector<int> numMidiReads(steps.size(), 0);
+    for (size_t i = 0; i < steps.size(); i++)
+        numPendingReads[i].assign((size_t) steps[i]->numOutputChannels, 0);
+    for (const auto &step : steps) {
+        for (const auto &channelInputs : step->audioInputs)
+            for (const auto &input : channelInputs)
+                numPendingReads[(size_t) input.stepIndex][(size_t) input.channel]++;
+        for (const int stepIndex : step->midiInputStepIndices)
+            numMidiReads[(size_t) stepIndex]++;
+    }
+
+    std::vector<int> freeBuffers;
+    int numBuffers = 0;
+    for (size_t stepIndex = 0; stepIndex < steps.size(); stepIndex++) {
+        auto &step = *steps[stepIndex];
+        step.isMidiInPlace = step.midiInputStepIndices.size() == 1 && numMidiReads[(size_t) step.midiInputStepIndices.front()] == 1;
+
+        step.channelBuffers.assign((size_t) step.numChannels, -1);
+        step.isChannelInPlace.assign((size_t) step.numChannels, false);
+        for (size_t channel = 0; channel < (size_t) step.numChannels; channel++) {
+            if (channel < step.audioInputs.size()) {
+                // An undelayed input that nothing else is going to read can be processed right where it is.
+                auto &inputs = step.audioInputs[channel];
+                auto inPlaceInput = std::find_if(inputs.begin(), inputs.end(), [&](const AudioInput &input) {
+                    return input.delay == nullptr && numPendingReads[(size_t) input.stepIndex][(size_t) input.channel] == 1;
+                });
+                if (inPlaceInput != inputs.end()) {
+                    std::iter_swap(inputs.begin(), inPlaceInput);
+                    const auto &input = inputs.front();
+                    step.channelBuffers[channel] = steps[(size_t) input.stepIndex]->channelBuffers[(size_t) input.channel];
+                    step.isChannelInPlace[channel] = true;
+                    numPendingReads[(size_t) input.stepIndex][(size_t) input.channel] = 0; // Now this step's buffer
+                    continue;
+                }
+            }
+            if (freeBuffers.empty()) {
+                step.channelBuffers[channel] = numBuffers++;
+            } else {
+                step.channelBuffers[channel] = freeBuffers.back();
+                freeBuffers.pop_back();
+            }
+        }
+
+        // Only once all of this step's buffers are assigned, so none of them is one it still reads from.
+        for (size_t channel = 0; channel < step.audioInputs.size(); channel++) {
+            const auto &inputs = step.audioInputs[channel];
+            const bool isInPlace = channel < step.isChannelInPlace.size() && step.isChannelInPlace[channel];
+            for (size_t i = isInPlace ? 1 : 0; i < inputs.size(); i++) {
+                const auto &input = inputs[i];
+                if (--numPendingReads[(size_t) input.stepIndex][(size_t) input.channel] == 0)
+                    freeBuffers.push_back(steps[(size_t) input.stepIndex]->channelBuffers[(size_t) input.channel]);
+            }
+        }
+        // Scratch channels, and outputs nothing reads.
+        for (size_t channel = 0; channel < (size_t) step.numChannels; channel++)
+            if ((int) channel >= step.numOutputChannels || numPendingReads[stepIndex][channel] == 0)
+                freeBuffers.push_back(step.channelBuffers[channel]);
+    }
+
+    bufferPool.setSize(numBuffers, blockSize);
+    for (auto &step : steps) {
+        // Never empty, since a buffer can't refer to null channel data, even with no channels.
+        step->channelPointers.assign((size_t) jmax(1, step->numChannels), nullptr);
+        for (size_t channel = 0; channel < (size_t) step->numChannels; channel++)
+            step->channelPointers[channel] = bufferPool.getWritePointer(step->channelBuffers[channel]);
+    }
+}
+
+void GraphRenderSequence::perform(AudioBuffer<float> &buffer, MidiBuffer &midiMessages, AudioPlayHead *playHead) {
+    const int numSamples = buffer.getNumSamples();
+    if (numSamples <= blockSize) {
+        performBlock(buffer, midiMessages, playHead);
+        return;
+    }
+
+    // More than was prepared for. Render it in chunks.
+    graphOutputMidi.clear();
+    for (int startSample = 0; startSample < numSamples; startSample += blockSize) {
+        const int chunkSize = jmin(blockSize, numSamples - startSample);
+        AudioBuffer<float> audioChunk(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), startSample, chunkSize);
+        chunkMidi.clear();
+        chunkMidi.addEvents(midiMessages, startSample, chunkSize, -startSample);
+        performBlock(audioChunk, chunkMidi, playHead);
+        graphOutputMidi.addEvents(chunkMidi, 0, chunkSize, startSample);
+    }
+    midiMessages.swapWith(graphOutputMidi);
+}
+
+void GraphRenderSequence::performBlock(AudioBuffer<float> &buffer, MidiBuffer &midiMessages, AudioPlayHead *playHead) {
+    for (size_t i = 0; i < numInputSteps; i++)
+        performStep(*steps[i], buffer, midiMessages, playHead);
+    midiMessages.clear();
+    for (size_t i = numInputSteps; i < steps.size(); i++)
+        performStep(*steps[i], buffer, midiMessages, playHead);
+
+    // Audio output nodes write their first inputs straight into the graph's buffer. Anything they don't write is silent.
+    for (int channel = 0; channel < buffer.getNumChannels(); channel++)
+        if ((size_t) channel >= isGraphOutputChannelWritten.size() || !isGraphOutputChannelWritten[(size_t) channel])
+            buffer.clear(channel, 0, buffer.getNumSamples());
+}
+
+void GraphRenderSequence::performStep(Step &step, AudioBuffer<float> &buffer, MidiBuffer &midiMessages, AudioPlayHead *playHead) {
+    const int numSamples = buffer.getNumSamples();
+    AudioBuffer<float> audio(step.channelPointers.data(), step.numChannels, numSamples);
+    switch (step.type) {
+        case Step::audioInput:
+            for (int channel = 0; channel < audio.getNumChannels(); channel++) {
+                if (channel < buffer.getNumChannels())
+                    FloatVectorOperations::copy(audio.getWritePointer(channel), buffer.getReadPointer(channel), numSamples);
+                else
+                    audio.clear(channel, 0, numSamples);
+            }
+            break;
+        case Step::audioOutput:
+            for (size_t channel = 0; channel < step.audioInputs.size() && (int) channel < buffer.getNumChannels(); channel++)
+                mixInputs(step.audioInputs[channel], 0, buffer.getWritePointer((int) channel), step.addsToGraphOutput[channel], numSamples);
+            break;
+        case Step::midiInput:
+            step.midi.clear();
+            step.midi.addEvents(midiMessages, 0, numSamples, 0);
+            break;
+        case Step::midiOutput:
+            gatherMidi(step, numSamples);
+            midiMessages.addEvents(step.midi, 0, numSamples, 0);
+            break;
+        case Step::process:
+            gatherInputs(step, audio);
+            processNode(*step.nodes.front(), audio, step.midi, playHead);
+            break;
+        case Step::fusedGainStages:
+            gatherInputs(step, audio);
+            processGainStages(step, audio, playHead);
+            break;
+    }
+}
+
+void GraphRenderSequence::mixInputs(const std::vector<AudioInput> &inputs, size_t firstInput, float *destination, bool accumulate, int numSamples) {
+    for (size_t i = firstInput; i < inputs.size(); i++) {
+        const auto &input = inputs[i];
+        const float *source = bufferPool.getReadPointer(steps[(size_t) input.stepIndex]->channelBuffers[(size_t) input.channel]);
+        if (input.delay != nullptr)
+            source = input.delay->process(source, numSamples);
+        if (accumulate || i > firstInput)
+            FloatVectorOperations::add(destination, source, numSamples);
+        else
+            FloatVectorOperations::copy(destination, source, numSamples);
+    }
+}
+
+void GraphRenderSequence::gatherInputs(Step &step, AudioBuffer<float> &audio) {
+    const int numSamples = audio.getNumSamples();
+    for (int channel = 0; channel < audio.getNumChannels(); channel++) {
+        const bool hasInputs = (size_t) channel < step.audioInputs.size() && !step.audioInputs[(size_t) channel].empty();
+        if (!hasInputs)
+            audio.clear(channel, 0, numSamples);
+        else if (step.isChannelInPlace[(size_t) channel])
+            mixInputs(step.audioInputs[(size_t) channel], 1, audio.getWritePointer(channel), true, numSamples);
+        else
+            mixInputs(step.audioInputs[(size_t) channel], 0, audio.getWritePointer(channel), false, numSamples);
+    }
+    gatherMidi(step, numSamples);
+}
+
+void GraphRenderSequence::gatherMidi(Step &step, int numSamples) {
+    if (step.isMidiInPlace) {
+        step.midi.swapWith(steps[(size_t) step.midiInputStepIndices.front()]->midi);
+        return;
+    }
+    step.midi.clear();
+    for (const int stepIndex : step.midiInputStepIndices)
+        step.midi.addEvents(steps[(size_t) stepIndex]->midi, 0, numSamples, 0);
+}
+
+void GraphRenderSequence::processNode(Node &node, AudioBuffer<float> &audio, MidiBuffer &midiMessages, AudioPlayHead *playHead) {
+    auto *processor = node.getProcessor();
+    processor->setPlayHead(playHead);
+    const ScopedLock callbackLock(processor->getCallbackLock());
+    if (processor->isSuspended())
+        audio.clear();
+    else if (node.isBypassed())
+        processor->processBlockBypassed(audio, midiMessages);
+    else
+        processor->processBlock(audio, midiMessages);
+}
+
+void GraphRenderSequence::processGainStages(Step &step, AudioBuffer<float> &audio, AudioPlayHead *playHead) {
+    // Every stage is locked for the whole block, so they're all rendered in one consistent state.
+    for (const auto &node : step.nodes)
+        node->getProcessor()->getCallbackLock().enter();
+
+    bool canFuse = true;
+    for (size_t i = 0; i < step.nodes.size() && canFuse; i++)
+        canFuse = !step.nodes[i]->getProcessor()->isSuspended() && !step.nodes[i]->isBypassed() && step.gainStages[i]->canFuse();
+
+    if (canFuse) {
+        const int numSamples = audio.getNumSamples();
+        float leftGains[GainStageProcessor::maxChunkSize], rightGains[GainStageProcessor::maxChunkSize];
+        for (int startSample = 0; startSample < numSamples; startSample += GainStageProcessor::maxChunkSize) {
+            const int chunkSize = jmin(GainStageProcessor::maxChunkSize, numSamples - startSample);
+            FloatVectorOperations::fill(leftGains, 1.0f, chunkSize);
+            FloatVectorOperations::fill(rightGains, 1.0f, chunkSize);
+            for (auto *gainStage : step.gainStages)
+                gainStage->accumulateGains(leftGains, rightGains, chunkSize, audio.getNumChannels() == 2);
+            GainStageProcessor::applyGains(audio, startSample, leftGains, rightGains, chunkSize);
+        }
+        for (size_t i = 0; i < step.gainStages.size(); i++) {
+            if (!step.gainStageReceivesMidi[i])
+                step.midi.clear();
+            step.gainStages[i]->processGainStageMidi(step.midi);
+        }
+        if (auto *meterSource = step.gainStages.back()->getStageMeterSource())
+            meterSource->measureBlock(audio);
+    } else {
+        // Some stage needs to see the actual audio (or can't process at all). Render the stages one at a time, in place.
+        for (size_t i = 0; i < step.nodes.size(); i++) {
+            if (!step.gainStageReceivesMidi[i])
+                step.midi.clear();
+            processNode(*step.nodes[i], audio, step.midi, playHead);
+        }
+    }
+
+    for (auto node = step.nodes.rbegin(); node != step.nodes.rend(); ++node)
+        (*node)->getProcessor()->getCallbackLock().exit();
+}
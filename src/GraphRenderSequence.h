@@ -0,0 +1,91 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "processors/GainStageProcessor.h"
+
+using namespace juce;
+
+// Renders a snapshot of an `AudioProcessorGraph`'s topology, in place of the stock `AudioProcessorGraph` rendering.
+// Compiled on the message thread whenever the graph changes, and then only `perform`ed on the audio thread.
+// Chains of `GainStageProcessor`s that feed nothing but each other are rendered as a single fused step.
+//
+// Channels don't get a buffer per node. Each step's channels are assigned buffers from a shared pool, which go back
+// to the pool as soon as their last reader is done with them, so the working set stays as small as the graph allows.
+// A step whose input is read by nothing after it takes that input's buffer over and processes it in place, and
+// buffers that get overwritten anyway (by a copy of a step's first input, or by the graph's input) are never cleared.
+class GraphRenderSequence {
+public:
+    using Node = AudioProcessorGraph::Node;
+    using NodeID = AudioProcessorGraph::NodeID;
+
+    GraphRenderSequence(const AudioProcessorGraph &graph, int blockSize);
+
+    ~GraphRenderSequence();
+
+    // The graph's total latency, from its audio inputs to its audio outputs.
+    int getLatencySamples() const { return latencySamples; }
+
+    void perform(AudioBuffer<float> &buffer, MidiBuffer &midiMessages, AudioPlayHead *playHead);
+
+private:
+    struct DelayLine;
+
+    // A (possibly delayed) output channel of an earlier step, feeding an input channel of a later one.
+    struct AudioInput {
+        int stepIndex, channel;
+        DelayLine *delay;
+    };
+
+    struct Step {
+        enum Type { process, fusedGainStages, audioInput, audioOutput, midiInput, midiOutput };
+
+        Type type{process};
+        // More than one only for fused gain stages, in chain order.
+        std::vector<Node::Ptr> nodes;
+        std::vector<GainStageProcessor *> gainStages;
+        // For each fused stage, whether it gets the MIDI of the stage before it (rather than no MIDI at all).
+        std::vector<bool> gainStageReceivesMidi;
+
+        // Indexed by input channel.
+        std::vector<std::vector<AudioInput>> audioInputs;
+        std::vector<int> midiInputStepIndices;
+
+        // Channels processed (audio output nodes don't have any, since they mix right into the graph's output).
+        int numChannels{0}, numOutputChannels{0};
+        // The pooled buffer of each channel, and whether it's the buffer of its first audio input, taken over to process in place.
+        std::vector<int> channelBuffers;
+        std::vector<bool> isChannelInPlace;
+        std::vector<float *> channelPointers;
+        // Whether the MIDI of its only MIDI input is swapped in, since nothing else reads it.
+        bool isMidiInPlace{false};
+        // Audio output nodes only: for each channel, whether an earlier audio output node already wrote that graph output channel.
+        std::vector<bool> addsToGraphOutput;
+
+        MidiBuffer midi;
+        int latencySamples{0};
+    };
+
+    std::vector<std::unique_ptr<Step>> steps;
+    // Graph input nodes always come first, so the graph's buffer is free for its outputs once they're done.
+    size_t numInputSteps{0};
+    std::vector<std::unique_ptr<DelayLine>> delayLines;
+    AudioBuffer<float> bufferPool;
+    std::vector<bool> isGraphOutputChannelWritten;
+
+    const int blockSize;
+    int latencySamples{0};
+
+    MidiBuffer graphOutputMidi, chunkMidi;
+
+    void compile(const AudioProcessorGraph &graph);
+    void allocateBuffers();
+    void performBlock(AudioBuffer<float> &buffer, MidiBuffer &midiMessages, AudioPlayHead *playHead);
+    void performStep(Step &step, AudioBuffer<float> &buffer, MidiBuffer &midiMessages, AudioPlayHead *playHead);
+
+    // Sum `inputs` (from `firstInput` on) into `destination`: on top of what's already there if `accumulate`, or replacing it otherwise.
+    void mixInputs(const std::vector<AudioInput> &inputs, size_t firstInput, float *destination, bool accumulate, int numSamples);
+    void gatherInputs(Step &step, AudioBuffer<float> &audio);
+    void gatherMidi(Step &step, int numSamples);
+    static void processNode(Node &node, AudioBuffer<float> &audio, MidiBuffer &midiMessages, AudioPlayHead *playHead);
+    static void processGainStages(Step &step, AudioBuffer<float> &audio, AudioPlayHead *playHead);
+};
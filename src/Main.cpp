@@ -2,26 +2,22 @@
 
 #include <BinaryData.h>
 #include "view/push2/Push2Component.h"
+#include "push2/VirtualPush2.h"
 #include "view/graph_editor/GraphEditor.h"
 #include "view/CustomColourIds.h"
 #include "view/BasicWindow.h"
 #include "ApplicationPropertiesAndCommandManager.h"
 #include "DeviceChangeMonitor.h"
+#include "PluginScanner.h"
+#include "processors/OutOfProcessPluginHost.h"
 #include "FlowGridConfig.h"
 #include "action/DeleteProcessor.h"
 
-class FlowGridApplication : public JUCEApplication, public MenuBarModel, public ChangeListener {
+class FlowGridApplication : public JUCEApplication, public MenuBarModel, public ChangeListener, public ProcessorGraph::Listener {
 public:
     FlowGridApplication() : view(undoManager),
                             tracks(view, undoManager, deviceManager),
-                            connections(tracks),
-                            input(pluginManager, undoManager, deviceManager),
-                            output(pluginManager, undoManager, deviceManager),
-                            allProcessors(tracks, input, output),
-                            push2Colours(tracks),
-                            push2MidiCommunicator(view, push2Colours),
-                            processorGraph(allProcessors, pluginManager, tracks, connections, input, output, undoManager, deviceManager, push2MidiCommunicator),
-                            project(view, tracks, connections, input, output, allProcessors, processorGraph, undoManager, pluginManager, deviceManager) {}
+                            connections(tracks) {}
 
     const String getApplicationName() override { return PROJECT_NAME; }
 
@@ -29,11 +25,40 @@ public:
 
     bool moreThanOneInstanceAllowed() override { return true; }
 
-    void initialise(const String &) override {
+    void initialise(const String &commandLine) override {
+        auto scannerChildProcess = std::make_unique<PluginScannerChildProcess>();
+        if (scannerChildProcess->initialiseFromCommandLine(commandLine, PluginScanner::childProcessCommandLineUID)) {
+            // Launched as a headless plugin scanner. It quits when the scanning app disconnects.
+            pluginScannerChildProcess = std::move(scannerChildProcess);
+            return;
+        }
+        auto pluginHostChildProcess = std::make_unique<OutOfProcessPluginHost>();
+        if (pluginHostChildProcess->initialiseFromCommandLine(commandLine, OutOfProcessPluginIPC::childProcessCommandLineUID)) {
+            // Launched to host a single plugin for an `OutOfProcessPluginInstance`.
+            outOfProcessPluginHost = std::move(pluginHostChildProcess);
+            return;
+        }
+
         Process::makeForegroundProcess();
 
-        project.addChangeListener(this);
+        // Only the app itself needs all of this. (Child processes are launched often, and should start fast.)
+        pluginManager = std::make_unique<PluginManager>();
+        input = std::make_unique<Input>(*pluginManager, undoManager, deviceManager);
+        output = std::make_unique<Output>(*pluginManager, undoManager, deviceManager);
+        allProcessors = std::make_unique<AllProcessors>(tracks, *input, *output);
+        push2Colours = std::make_unique<Push2Colours>(tracks);
+        push2MidiCommunicator = std::make_unique<Push2MidiCommunicator>(view, *push2Colours);
+        workerPool = std::make_unique<ThreadPool>(SystemStats::getNumCpus());
+        processorGraph = std::make_unique<ProcessorGraph>(*allProcessors, *pluginManager, tracks, connections, *input, *output, undoManager, deviceManager,
+                                                          *push2MidiCommunicator, *workerPool);
+        project = std::make_unique<Project>(view, tracks, connections, *input, *output, *allProcessors, *processorGraph, undoManager, *pluginManager, deviceManager);
+
+        project->addChangeListener(this);
+        processorGraph->addListener(this);
         undoManager.addChangeListener(this);
+        // Undo action sizes are (roughly) in bytes. The oldest transactions are dropped once the history outgrows this.
+        undoManager.setMaxNumberOfStoredUnits(getUserSettings()->getIntValue("undoHistoryMemoryBudget", DEFAULT_UNDO_HISTORY_MEMORY_BUDGET),
+                                              MIN_UNDO_TRANSACTIONS_TO_KEEP);
 
         deviceChangeMonitor = std::make_unique<DeviceChangeMonitor>(deviceManager);
 
@@ -51,38 +76,68 @@ public:
         lookAndFeel.setColour(Slider::rotarySliderOutlineColourId,
                               lookAndFeel.findColour(Slider::rotarySliderOutlineColourId).brighter(0.06f));
 
-        pluginListComponent = std::unique_ptr<PluginListComponent>(pluginManager.makePluginListComponent());
+        pluginListComponent = std::unique_ptr<PluginListComponent>(pluginManager->makePluginListComponent());
 
         auto savedAudioState = getUserSettings()->getXmlValue("audioDeviceState");
         deviceManager.initialise(256, 256, savedAudioState.get(), true);
 
         deviceManager.addChangeListener(this);
 
-        mainWindow = std::make_unique<MainWindow>(*this, "FlowGrid", new GraphEditor(view, tracks, connections, input, output, processorGraph, project, pluginManager));
+        mainWindow = std::make_unique<MainWindow>(*this, "FlowGrid", new GraphEditor(view, tracks, connections, *input, *output, *processorGraph, *project, *pluginManager));
         mainWindow->setBoundsRelative(0.02f, 0.02f, 0.96f, 0.96f);
 
-        push2Component = std::make_unique<Push2Component>(view, tracks, connections, project, processorGraph.getProcessorWrappers(), push2MidiCommunicator);
+        push2Component = std::make_unique<Push2Component>(view, tracks, connections, *project, processorGraph->getProcessorWrappers(), *push2MidiCommunicator);
 
-        push2MidiCommunicator.setPush2Listener(push2Component.get());
+        push2MidiCommunicator->setPush2Listener(push2Component.get());
+
+        // Stand in for the Push 2 with a virtual one, e.g. to run without the hardware.
+        // `--virtual-push2=<directory>` also saves every frame it gets as a PNG, and `--push2-script=<file.mid>` plays its events.
+        // `--push2-benchmark=<numFrames>` (see `runPush2Benchmark`) implies `--virtual-push2`.
+        const ArgumentList arguments(getApplicationName(), commandLine);
+        if (arguments.containsOption("--virtual-push2") || arguments.containsOption("--push2-benchmark")) {
+            virtualPush2 = std::make_unique<VirtualPush2>(*push2MidiCommunicator, *push2Component);
+            const auto captureDirectory = arguments.getValueForOption("--virtual-push2");
+            if (captureDirectory.isNotEmpty())
+                virtualPush2->getDisplay().setCaptureDirectory(File::getCurrentWorkingDirectory().getChildFile(captureDirectory));
+        }
 
-        player.setProcessor(&processorGraph);
+        player.setProcessor(processorGraph.get());
         deviceManager.addAudioCallback(&player);
 
-        project.initialize();
-        processorGraph.removeIllegalConnections();
+        project->initialize();
+        processorGraph->removeIllegalConnections();
         undoManager.clearUndoHistory();
 
         getCommandManager().registerAllCommandsForTarget(this);
         push2Component->setVisible(true);
+
+        const auto push2Script = arguments.getValueForOption("--push2-script");
+        if (virtualPush2 != nullptr && push2Script.isNotEmpty())
+            virtualPush2->playScript(VirtualPush2::loadScript(File::getCurrentWorkingDirectory().getChildFile(push2Script)));
+
+        if (arguments.containsOption("--push2-benchmark")) {
+            const int numFrames = jmax(1, arguments.getValueForOption("--push2-benchmark").getIntValue());
+            const auto referenceFramePath = arguments.getValueForOption("--push2-reference-frame");
+            const auto referenceFrameFile = referenceFramePath.isNotEmpty() ? File::getCurrentWorkingDirectory().getChildFile(referenceFramePath) : File();
+            // Once the project is loaded and the first frames are out.
+            Timer::callAfterDelay(1000, [this, numFrames, referenceFrameFile] { runPush2Benchmark(numFrames, referenceFrameFile); });
+        }
     }
 
     void shutdown() override {
+        pluginScannerChildProcess = nullptr;
+        outOfProcessPluginHost = nullptr;
+        virtualPush2 = nullptr;
         push2Component = nullptr;
         push2Window = nullptr;
         deviceChangeMonitor = nullptr;
+        // A child process is done here.
+        if (project == nullptr) return;
+
         deviceManager.removeAudioCallback(&player);
         undoManager.removeChangeListener(this);
-        project.removeChangeListener(this);
+        processorGraph->removeListener(this);
+        project->removeChangeListener(this);
         setMacMainMenu(nullptr);
     }
 
@@ -133,6 +188,8 @@ public:
             menu.addCommandItem(&getCommandManager(), CommandIDs::duplicateSelected);
             menu.addSeparator();
             menu.addCommandItem(&getCommandManager(), CommandIDs::deleteSelected);
+            menu.addSeparator();
+            menu.addCommandItem(&getCommandManager(), CommandIDs::freezeTrack);
         } else if (topLevelMenuIndex == 2) { // Create menu
             menu.addCommandItem(&getCommandManager(), CommandIDs::insertTrack);
             menu.addCommandItem(&getCommandManager(), CommandIDs::insertProcessorLane);
@@ -143,7 +200,7 @@ public:
             menu.addCommandItem(&getCommandManager(), CommandIDs::showAudioMidiSettings);
             menu.addCommandItem(&getCommandManager(), CommandIDs::showPluginListEditor);
 
-            const auto &pluginSortMethod = pluginManager.getPluginSortMethod();
+            const auto &pluginSortMethod = pluginManager->getPluginSortMethod();
 
             PopupMenu sortTypeMenu;
             sortTypeMenu.addItem(200, "List plugins in default order", true, pluginSortMethod == KnownPluginList::defaultOrder);
@@ -163,8 +220,8 @@ public:
                 RecentlyOpenedFilesList recentFiles;
                 recentFiles.restoreFromString(getUserSettings()->getValue("recentProjectFiles"));
 
-                if (project.saveIfNeededAndUserAgrees() == FileBasedDocument::savedOk) {
-                    project.loadFrom(recentFiles.getFile(menuItemID - 100), true);
+                if (project->saveIfNeededAndUserAgrees() == FileBasedDocument::savedOk) {
+                    project->loadFrom(recentFiles.getFile(menuItemID - 100), true);
                 }
             }
         } else if (topLevelMenuIndex == 1) { // Edit menu
@@ -174,13 +231,13 @@ public:
             if (menuItemID == 1) {
                 showAudioMidiSettings();
             } else if (menuItemID >= 200 && menuItemID < 210) {
-                if (menuItemID == 200) pluginManager.setPluginSortMethod(KnownPluginList::defaultOrder);
-                else if (menuItemID == 201) pluginManager.setPluginSortMethod(KnownPluginList::sortAlphabetically);
-                else if (menuItemID == 202) pluginManager.setPluginSortMethod(KnownPluginList::sortByCategory);
-                else if (menuItemID == 203) pluginManager.setPluginSortMethod(KnownPluginList::sortByManufacturer);
-                else if (menuItemID == 204) pluginManager.setPluginSortMethod(KnownPluginList::sortByFileSystemLocation);
+                if (menuItemID == 200) pluginManager->setPluginSortMethod(KnownPluginList::defaultOrder);
+                else if (menuItemID == 201) pluginManager->setPluginSortMethod(KnownPluginList::sortAlphabetically);
+                else if (menuItemID == 202) pluginManager->setPluginSortMethod(KnownPluginList::sortByCategory);
+                else if (menuItemID == 203) pluginManager->setPluginSortMethod(KnownPluginList::sortByManufacturer);
+                else if (menuItemID == 204) pluginManager->setPluginSortMethod(KnownPluginList::sortByFileSystemLocation);
 
-                getUserSettings()->setValue("pluginSortMethod", (int) pluginManager.getPluginSortMethod());
+                getUserSettings()->setValue("pluginSortMethod", (int) pluginManager->getPluginSortMethod());
                 menuItemsChanged();
             }
         }
@@ -203,6 +260,7 @@ public:
                 CommandIDs::insertTrack,
                 CommandIDs::insertProcessorLane,
                 CommandIDs::createMasterTrack,
+                CommandIDs::freezeTrack,
                 CommandIDs::showPush2MirrorWindow,
                 CommandIDs::navigateLeft,
                 CommandIDs::navigateRight,
@@ -233,7 +291,7 @@ public:
             case CommandIDs::save:
                 result.setInfo("Save", "Saves the current project", category, 0);
                 result.defaultKeypresses.add(KeyPress('s', ModifierKeys::commandModifier, 0));
-                result.setActive(project.hasChangedSinceSaved());
+                result.setActive(project->hasChangedSinceSaved());
                 break;
             case CommandIDs::saveAs:
                 result.setInfo("Save As...", "Saves a copy of the current project", category, 0);
@@ -257,7 +315,7 @@ public:
             case CommandIDs::insert:
                 result.setInfo("Insert", String(), category, 0);
                 result.addDefaultKeypress('v', ModifierKeys::commandModifier);
-                result.setActive(project.hasCopy());
+                result.setActive(project->hasCopy());
                 break;
             case CommandIDs::duplicateSelected:
                 result.setInfo("Duplicate selected item(s)", String(), category, 0);
@@ -283,6 +341,14 @@ public:
                 result.addDefaultKeypress('m', ModifierKeys::commandModifier | ModifierKeys::shiftModifier);
                 result.setActive(tracks.getMasterTrack() == nullptr);
                 break;
+            case CommandIDs::freezeTrack: {
+                const auto *focusedTrack = tracks.getFocusedTrack();
+                result.setInfo("Freeze track", "Renders the focused track and suspends its processors until it's edited", category, 0);
+                result.addDefaultKeypress('f', ModifierKeys::commandModifier | ModifierKeys::shiftModifier);
+                result.setActive(processorGraph->isTrackFrozen(focusedTrack) || processorGraph->canFreezeTrack(focusedTrack));
+                result.setTicked(processorGraph->isTrackFrozen(focusedTrack));
+                break;
+            }
             case CommandIDs::showPush2MirrorWindow:
                 result.setInfo("Open a window mirroring a Push 2 display", String(), category, 0);
                 break;
@@ -333,61 +399,69 @@ public:
     bool perform(const InvocationInfo &info) override {
         switch (info.commandID) {
             case CommandIDs::newFile:
-                if (project.saveIfNeededAndUserAgrees() == FileBasedDocument::savedOk)
-                    project.newDocument();
+                if (project->saveIfNeededAndUserAgrees() == FileBasedDocument::savedOk)
+                    project->newDocument();
                 break;
             case CommandIDs::open:
-                if (project.saveIfNeededAndUserAgrees() == FileBasedDocument::savedOk)
-                    project.loadFromUserSpecifiedFile(true);
+                if (project->saveIfNeededAndUserAgrees() == FileBasedDocument::savedOk)
+                    project->loadFromUserSpecifiedFile(true);
                 break;
             case CommandIDs::save:
-                project.save(true, true);
+                project->save(true, true);
                 break;
             case CommandIDs::saveAs:
-                project.saveAs(File(), true, true, true);
+                project->saveAs(File(), true, true, true);
                 break;
             case CommandIDs::undo:
-                project.undo();
+                project->undo();
                 break;
             case CommandIDs::redo:
-                project.redo();
+                project->redo();
                 break;
             case CommandIDs::copySelected:
-                project.copySelectedItems();
+                project->copySelectedItems();
                 applicationCommandListChanged(); // enable paste menu item
                 break;
             case CommandIDs::insert:
-                project.insert();
+                project->insert();
                 break;
             case CommandIDs::duplicateSelected:
-                project.duplicateSelectedItems();
+                project->duplicateSelectedItems();
                 break;
             case CommandIDs::deleteSelected:
-                project.deleteSelectedItems();
+                project->deleteSelectedItems();
                 break;
             case CommandIDs::insertTrack:
-                project.createTrack(false);
+                project->createTrack(false);
                 break;
             case CommandIDs::insertProcessorLane:
                 // TODO
                 break;
             case CommandIDs::createMasterTrack:
-                project.createTrack(true);
+                project->createTrack(true);
+                break;
+            case CommandIDs::freezeTrack:
+                if (auto *focusedTrack = tracks.getFocusedTrack()) {
+                    if (processorGraph->isTrackFrozen(focusedTrack))
+                        processorGraph->unfreezeTrack(focusedTrack);
+                    else
+                        processorGraph->freezeTrack(focusedTrack);
+                }
                 break;
             case CommandIDs::showPush2MirrorWindow:
                 showPush2MirrorWindow();
                 break;
             case CommandIDs::navigateLeft:
-                project.navigateLeft();
+                project->navigateLeft();
                 break;
             case CommandIDs::navigateRight:
-                project.navigateRight();
+                project->navigateRight();
                 break;
             case CommandIDs::navigateUp:
-                project.navigateUp();
+                project->navigateUp();
                 break;
             case CommandIDs::navigateDown:
-                project.navigateDown();
+                project->navigateDown();
                 break;
             case CommandIDs::showPluginListEditor:
                 showPluginList();
@@ -433,8 +507,8 @@ public:
 
         void modifierKeysChanged(const ModifierKeys &modifiers) override {
             DocumentWindow::modifierKeysChanged(modifiers);
-            owner.project.setShiftHeld(modifiers.isShiftDown());
-            owner.project.setAltHeld(modifiers.isAltDown());
+            owner.project->setShiftHeld(modifiers.isShiftDown());
+            owner.project->setAltHeld(modifiers.isAltDown());
         }
 
         void closeButtonPressed() override {
@@ -458,7 +532,7 @@ public:
         };
 
         void tryToQuitApplication() {
-            if (owner.project.saveIfNeededAndUserAgrees() != FileBasedDocument::savedOk)
+            if (owner.project->saveIfNeededAndUserAgrees() != FileBasedDocument::savedOk)
                 return;
 
             if (graphEditor->closeAnyOpenPluginWindows()) {
@@ -483,8 +557,8 @@ public:
 
         void filesDropped(const StringArray &files, int x, int y) override {
             if (files.size() == 1 && File(files[0]).hasFileExtension(Project::getFilenameSuffix())) {
-                if (owner.project.saveIfNeededAndUserAgrees() == FileBasedDocument::savedOk)
-                    owner.project.loadFrom(File(files[0]), true);
+                if (owner.project->saveIfNeededAndUserAgrees() == FileBasedDocument::savedOk)
+                    owner.project->loadFrom(File(files[0]), true);
             }
         }
 
@@ -502,7 +576,10 @@ public:
     ApplicationPropertiesAndCommandManager applicationPropertiesAndCommandManager;
 
 private:
-    PluginManager pluginManager;
+    // Only created when running as the app (see `initialise`).
+    std::unique_ptr<PluginManager> pluginManager;
+
+    static constexpr int DEFAULT_UNDO_HISTORY_MEMORY_BUDGET = 64 * 1024 * 1024, MIN_UNDO_TRANSACTIONS_TO_KEEP = 30;
 
     UndoManager undoManager;
     AudioDeviceManager deviceManager;
@@ -510,23 +587,56 @@ private:
     View view;
     Tracks tracks;
     Connections connections;
-    Input input;
-    Output output;
-    AllProcessors allProcessors;
+    std::unique_ptr<Input> input;
+    std::unique_ptr<Output> output;
+    std::unique_ptr<AllProcessors> allProcessors;
 
-    Push2Colours push2Colours;
-    Push2MidiCommunicator push2MidiCommunicator;
-    ProcessorGraph processorGraph;
-    Project project;
+    std::unique_ptr<Push2Colours> push2Colours;
+    std::unique_ptr<Push2MidiCommunicator> push2MidiCommunicator;
+    // For everything that's done in parallel (instantiating plugins, capturing their state, ...).
+    std::unique_ptr<ThreadPool> workerPool;
+    std::unique_ptr<ProcessorGraph> processorGraph;
+    std::unique_ptr<Project> project;
 
     AudioProcessorPlayer player;
 
     std::unique_ptr<DeviceChangeMonitor> deviceChangeMonitor;
 
     std::unique_ptr<Push2Component> push2Component;
+    std::unique_ptr<VirtualPush2> virtualPush2;
     std::unique_ptr<MainWindow> mainWindow;
     std::unique_ptr<DocumentWindow> push2Window;
     std::unique_ptr<PluginListComponent> pluginListComponent;
+    std::unique_ptr<PluginScannerChildProcess> pluginScannerChildProcess;
+    std::unique_ptr<OutOfProcessPluginHost> outOfProcessPluginHost;
+
+    // Print how fast the Push 2 views render and convert frames on the virtual Push 2, along with its frame and LED message rates, and quit.
+    // If `referenceFrameFile` is given (`--push2-reference-frame=<file.png>`), also fail (with a nonzero exit code)
+    // if the latest frame differs from it, and save the latest frame next to it for comparison.
+    void runPush2Benchmark(int numFrames, const File &referenceFrameFile) {
+        virtualPush2->resetStats();
+        const auto frameRenderingMs = virtualPush2->measureFrameRenderingMs(numFrames);
+        const auto frameConversionMs = VirtualPush2::measureFrameConversionMs(numFrames);
+        const auto stats = virtualPush2->getStats();
+        std::cout << "Push 2 frame rendering: " << frameRenderingMs << " ms" << std::endl;
+        std::cout << "Push 2 frame conversion: " << frameConversionMs << " ms" << std::endl;
+        std::cout << "Push 2 frames published: " << stats.numFramesPublished << " (" << stats.getFramesPerSecond() << "/s), resent: " << stats.numFramesResent << std::endl;
+        std::cout << "Push 2 LED messages: " << stats.numLedMessages << ", SysEx messages: " << stats.numSysExMessages
+                  << " (" << stats.getLedMessagesPerSecond() << "/s)" << std::endl;
+
+        if (referenceFrameFile != File()) {
+            const auto frameImage = virtualPush2->getDisplay().getLatestFrameImage();
+            const auto referenceFrameImage = ImageFileFormat::loadFrom(referenceFrameFile);
+            const int numDifferentPixels = referenceFrameImage.getBounds() == frameImage.getBounds() ?
+                                           VirtualPush2Display::countDifferentPixels(frameImage, referenceFrameImage) : frameImage.getWidth() * frameImage.getHeight();
+            std::cout << "Push 2 pixels differing from " << referenceFrameFile.getFullPathName() << ": " << numDifferentPixels << std::endl;
+            if (numDifferentPixels > 0) {
+                virtualPush2->getDisplay().saveLatestFrame(referenceFrameFile.getSiblingFile(referenceFrameFile.getFileNameWithoutExtension() + "_actual.png"));
+                setApplicationReturnValue(1);
+            }
+        }
+        quit();
+    }
 
     void showAudioMidiSettings() {
         auto *audioSettingsComponent = new AudioDeviceSelectorComponent(deviceManager, 2, 256, 2, 256, true, true, true, false);
@@ -569,47 +679,56 @@ private:
         }
     }
 
+    // Show how far along loading the project's plugins is in the window title.
+    void processorInstantiationProgressChanged(int numInstantiated, int numToInstantiate) override {
+        String title = project->getDocumentTitle();
+        if (numInstantiated < numToInstantiate)
+            title << " - " << TRANS("Loading plugins") << " (" << numInstantiated << "/" << numToInstantiate << ")";
+        mainWindow->setName(title);
+    }
+
     void changeListenerCallback(ChangeBroadcaster *source) override {
-        if (source == &project) {
-            mainWindow->setName(project.getDocumentTitle());
+        if (source == project.get()) {
+            mainWindow->setName(project->getDocumentTitle());
         } else if (source == &undoManager) {
             applicationCommandListChanged();
         } else if (source == &deviceManager) {
             const String &push2MidiDeviceName = Push2MidiDevice::getDeviceName();
-            if (!push2MidiCommunicator.isInitialized() && MidiInput::getDevices().contains(push2MidiDeviceName, true)) {
-                auto midiInput = MidiInput::openDevice(MidiInput::getDevices().indexOf(push2MidiDeviceName, true), &push2MidiCommunicator);
+            // (The virtual Push 2 stays connected, if there is one.)
+            if (virtualPush2 == nullptr && !push2MidiCommunicator->isInitialized() && MidiInput::getDevices().contains(push2MidiDeviceName, true)) {
+                auto midiInput = MidiInput::openDevice(MidiInput::getDevices().indexOf(push2MidiDeviceName, true), push2MidiCommunicator.get());
                 auto midiOutput = MidiOutput::openDevice(MidiOutput::getDevices().indexOf(push2MidiDeviceName, true));
-                push2MidiCommunicator.setMidiInputAndOutput(std::move(midiInput), std::move(midiOutput));
+                push2MidiCommunicator->setMidiInputAndOutput(std::move(midiInput), std::move(midiOutput));
                 push2Component->setVisible(true); // refreshes button lights
 
                 // Always enable Push 2 as a midi input device when it's connected (even if it's been disabled, for simplicity)
                 deviceManager.setMidiInputEnabled(push2MidiDeviceName, true);
-            } else if (push2MidiCommunicator.isInitialized() && !MidiInput::getDevices().contains(push2MidiDeviceName, true)) {
-                push2MidiCommunicator.setMidiInputAndOutput(nullptr, nullptr);
+            } else if (virtualPush2 == nullptr && push2MidiCommunicator->isInitialized() && !MidiInput::getDevices().contains(push2MidiDeviceName, true)) {
+                push2MidiCommunicator->setMidiInputAndOutput(nullptr, nullptr);
             }
             auto audioState = deviceManager.createStateXml();
             getUserSettings()->setValue("audioDeviceState", audioState.get());
             getUserSettings()->saveIfNeeded();
 
             deviceManager.updateEnabledMidiInputsAndOutputs();
-            auto inputProcessorsToDelete = input.syncInputDevicesWithDeviceManager();
+            auto inputProcessorsToDelete = input->syncInputDevicesWithDeviceManager();
             for (auto *inputProcessor : inputProcessorsToDelete) {
-                undoManager.perform(new DeleteProcessor(inputProcessor, tracks, connections, processorGraph));
+                undoManager.perform(new DeleteProcessor(inputProcessor, tracks, connections, *processorGraph));
             }
             AudioDeviceManager::AudioDeviceSetup config;
             deviceManager.getAudioDeviceSetup(config);
             // TODO the undomanager behavior around this needs more thinking.
             //  This should be done along with the work to keep disabled IO devices in the graph if they still have connections
-            input.setDeviceName(config.inputDeviceName);
+            input->setDeviceName(config.inputDeviceName);
 
             deviceManager.updateEnabledMidiInputsAndOutputs();
-            auto outputProcessorsToDelete = output.syncOutputDevicesWithDeviceManager();
+            auto outputProcessorsToDelete = output->syncOutputDevicesWithDeviceManager();
             for (auto *outputProcessor : outputProcessorsToDelete) {
-                undoManager.perform(new DeleteProcessor(outputProcessor, tracks, connections, processorGraph));
+                undoManager.perform(new DeleteProcessor(outputProcessor, tracks, connections, *processorGraph));
             }
             // TODO the undomanager behavior around this needs more thinking.
             //  This should be done along with the work to keep disabled IO devices in the graph if they still have connections
-            output.setDeviceName(config.outputDeviceName);
+            output->setDeviceName(config.outputDeviceName);
         }
     }
 };
@@ -1,6 +1,8 @@
 #include "PluginManager.h"
 
 #include "ApplicationPropertiesAndCommandManager.h"
+#include "PluginScanner.h"
+#include "processors/OutOfProcessPluginIPC.h"
 
 PluginManager::PluginManager() {
     if (auto savedPluginList = getUserSettings()->getXmlValue(PLUGIN_LIST_FILE_NAME))
@@ -15,14 +17,19 @@ PluginManager::PluginManager() {
 
     pluginSortMethod = (KnownPluginList::SortMethod) getUserSettings()->getIntValue("pluginSortMethod", KnownPluginList::sortByCategory);
     knownPluginListExternal.addChangeListener(this);
+    knownPluginListExternal.setCustomScanner(std::make_unique<PluginScanner>());
+    outOfProcessPluginIdentifiers.addLines(getUserSettings()->getValue(OUT_OF_PROCESS_PLUGINS_NAME));
+    outOfProcessPluginIdentifiers.removeEmptyStrings();
 
     formatManager.addDefaultFormats();
     formatManager.addFormat(new InternalPluginFormat());
 }
 
 PluginListComponent *PluginManager::makePluginListComponent() {
-    const File &deadMansPedalFile = getUserSettings()->getFile().getSiblingFile("RecentlyCrashedPluginsList");
-    return new PluginListComponent(formatManager, knownPluginListExternal, deadMansPedalFile, getUserSettings(), true);
+    // No dead man's pedal file needed. Plugins are scanned out-of-process, and the ones that crash their scanner get blacklisted.
+    auto *pluginListComponent = new PluginListComponent(formatManager, knownPluginListExternal, File(), getUserSettings(), true);
+    pluginListComponent->setNumberOfThreadsForScanning(jmax(1, SystemStats::getNumCpus()));
+    return pluginListComponent;
 }
 
 std::unique_ptr<PluginDescription> PluginManager::getDescriptionForIdentifier(const String &identifier) {
@@ -30,6 +37,21 @@ std::unique_ptr<PluginDescription> PluginManager::getDescriptionForIdentifier(co
     return description != nullptr ? std::move(description) : knownPluginListExternal.getTypeForIdentifierString(identifier);
 }
 
+bool PluginManager::shouldHostOutOfProcess(const PluginDescription &description) const {
+    return OutOfProcessPluginIPC::isSupported && !InternalPluginFormat::isInternalPlugin(description) &&
+           outOfProcessPluginIdentifiers.contains(description.createIdentifierString());
+}
+
+void PluginManager::setHostOutOfProcess(const PluginDescription &description, bool hostOutOfProcess) {
+    const auto identifier = description.createIdentifierString();
+    if (hostOutOfProcess)
+        outOfProcessPluginIdentifiers.addIfNotAlreadyThere(identifier);
+    else
+        outOfProcessPluginIdentifiers.removeString(identifier);
+    getUserSettings()->setValue(OUT_OF_PROCESS_PLUGINS_NAME, outOfProcessPluginIdentifiers.joinIntoString("\n"));
+    getApplicationProperties().saveIfNeeded();
+}
+
 void PluginManager::addPluginsToMenu(PopupMenu &menu) {
     PopupMenu internalSubMenu;
     PopupMenu externalSubMenu;
@@ -14,6 +14,14 @@ public:
     KnownPluginList::SortMethod getPluginSortMethod() const { return pluginSortMethod; }
     AudioPluginFormatManager &getFormatManager() { return formatManager; }
     PluginDescription getChosenType(int menuId);
+    // Internal processors don't need the message thread while being created, and neither do plugins hosted out of process
+    // (those are created on the host process's message thread), so they can be instantiated on worker threads.
+    bool canCreateInstanceOffMessageThread(const PluginDescription &description) const {
+        return InternalPluginFormat::isInternalPlugin(description) || shouldHostOutOfProcess(description);
+    }
+    // Plugins the user chose to run in a separate process (see `OutOfProcessPluginInstance`). Applies to newly created instances.
+    bool shouldHostOutOfProcess(const PluginDescription &description) const;
+    void setHostOutOfProcess(const PluginDescription &description, bool hostOutOfProcess);
 
     PluginListComponent *makePluginListComponent();
     void setPluginSortMethod(const KnownPluginList::SortMethod pluginSortMethod) { this->pluginSortMethod = pluginSortMethod; }
@@ -25,6 +33,7 @@ public:
 
 private:
     const String PLUGIN_LIST_FILE_NAME = "pluginList";
+    const String OUT_OF_PROCESS_PLUGINS_NAME = "outOfProcessPlugins";
 
     InternalPluginFormat internalFormat;
     KnownPluginList knownPluginListExternal;
@@ -36,6 +45,7 @@ private:
 
     Array<PluginDescription> externalPluginDescriptions;
     Array<PluginDescription> userCreatableInternalPluginDescriptions;
+    StringArray outOfProcessPluginIdentifiers;
 
     void changeListenerCallback(ChangeBroadcaster *changed) override;
 };
@@ -0,0 +1,239 @@
+#include "PluginScanner.h"
+
+#include "ApplicationPropertiesAndCommandManager.h"
+#include "processors/InternalPluginFormat.h"
+
+static constexpr int childProcessTimeoutMs = 10000;
+// A plugin that takes longer than this to scan is treated like one that crashed.
+static constexpr int maxScanTimeMs = 2 * 60 * 1000;
+
+struct PluginScanner::ChildProcess : private ChildProcessCoordinator {
+    bool launch() {
+        return launchWorkerProcess(File::getSpecialLocation(File::currentExecutableFile), childProcessCommandLineUID, childProcessTimeoutMs);
+    }
+
+    enum class ScanResult { scanned, crashed, abandoned };
+
+    // Only the plugin is to blame if the child process `crashed` (or stopped responding) while scanning it.
+    // The scan is `abandoned` if it was cancelled, or the request couldn't be sent at all.
+    // The child process can't be used again after either.
+    ScanResult scan(const KnownPluginList::CustomScanner &scanner, const String &formatName, const String &fileOrIdentifier, OwnedArray<PluginDescription> &result) {
+        replyReceived.reset();
+        MemoryOutputStream request;
+        request.writeString(formatName);
+        request.writeString(fileOrIdentifier);
+        if (connectionLost || !sendMessageToWorker(request.getMemoryBlock()))
+            return ScanResult::abandoned;
+
+        for (const auto startTime = Time::getMillisecondCounter(); !replyReceived.wait(50);) {
+            if (scanner.shouldExit())
+                return ScanResult::abandoned;
+            if (Time::getMillisecondCounter() - startTime > (uint32) maxScanTimeMs)
+                return ScanResult::crashed;
+        }
+        if (connectionLost)
+            return ScanResult::crashed;
+
+        const ScopedLock scopedLock(replyLock);
+        if (auto xml = parseXML(reply))
+            for (auto *descriptionXml : xml->getChildIterator()) {
+                auto description = std::make_unique<PluginDescription>();
+                if (description->loadFromXml(*descriptionXml))
+                    result.add(description.release());
+            }
+        return ScanResult::scanned;
+    }
+
+private:
+    WaitableEvent replyReceived;
+    CriticalSection replyLock;
+    String reply;
+    std::atomic<bool> connectionLost{false};
+
+    void handleMessageFromWorker(const MemoryBlock &message) override {
+        {
+            const ScopedLock scopedLock(replyLock);
+            reply = message.toString();
+        }
+        replyReceived.signal();
+    }
+
+    void handleConnectionLost() override {
+        connectionLost = true;
+        replyReceived.signal();
+    }
+};
+
+PluginScanner::PluginScanner() {
+    if (auto savedCache = getUserSettings()->getXmlValue(PLUGIN_SCAN_CACHE_NAME)) {
+        for (auto *fileXml : savedCache->getChildIterator()) {
+            auto entry = std::make_unique<CacheEntry>();
+            entry->signature = fileXml->getStringAttribute("signature").getLargeIntValue();
+            for (auto *descriptionXml : fileXml->getChildIterator()) {
+                auto description = std::make_unique<PluginDescription>();
+                if (description->loadFromXml(*descriptionXml))
+                    entry->descriptions.add(description.release());
+            }
+            cache[fileXml->getStringAttribute("path")] = std::move(entry);
+        }
+    }
+}
+
+PluginScanner::~PluginScanner() {
+    saveCache();
+}
+
+bool PluginScanner::findPluginTypesFor(AudioPluginFormat &format, OwnedArray<PluginDescription> &result, const String &fileOrIdentifier) {
+    if (findCachedPluginTypesFor(fileOrIdentifier, result))
+        return true;
+
+    // Internal plugins can't crash the scan, and aren't files anyway.
+    if (dynamic_cast<InternalPluginFormat *>(&format) != nullptr) {
+        format.findAllTypesForFile(result, fileOrIdentifier);
+        return true;
+    }
+
+    std::unique_ptr<ChildProcess> childProcess;
+    {
+        const ScopedLock scopedLock(lock);
+        if (!idleChildProcesses.isEmpty())
+            childProcess.reset(idleChildProcesses.removeAndReturn(idleChildProcesses.size() - 1));
+    }
+    if (childProcess == nullptr) {
+        childProcess = std::make_unique<ChildProcess>();
+        // Not the plugin's fault, so it isn't blacklisted. It just isn't found this time.
+        if (!childProcess->launch())
+            return true;
+    }
+
+    switch (childProcess->scan(*this, format.getName(), fileOrIdentifier, result)) {
+        case ChildProcess::ScanResult::crashed:
+            return false; // Blacklists this plugin. The crashed child process is dropped.
+        case ChildProcess::ScanResult::abandoned:
+            return true; // Nothing found, and nothing blacklisted. The child process is dropped.
+        case ChildProcess::ScanResult::scanned:
+            break;
+    }
+
+    cachePluginTypesFor(fileOrIdentifier, result);
+    const ScopedLock scopedLock(lock);
+    idleChildProcesses.add(childProcess.release());
+    return true;
+}
+
+void PluginScanner::scanFinished() {
+    {
+        const ScopedLock scopedLock(lock);
+        idleChildProcesses.clear();
+    }
+    saveCache();
+}
+
+static void addToSignature(String &signature, const File &file) {
+    signature << file.getLastModificationTime().toMilliseconds() << ':' << file.getSize() << ';';
+}
+
+bool PluginScanner::getFileSignature(const String &fileOrIdentifier, int64 &signature) {
+    if (!File::isAbsolutePath(fileOrIdentifier)) return false;
+
+    const File file(fileOrIdentifier);
+    if (!file.exists()) return false;
+
+    String signatureText;
+    addToSignature(signatureText, file);
+    // Plugin bundles are directories, whose own modification time and size don't change along with the binary inside.
+    // So their binaries (in `Contents/MacOS`, or `Contents/<architecture>-linux` / `-win` for VST3) and `Info.plist` are included too.
+    if (file.isDirectory()) {
+        const auto contents = file.getChildFile("Contents");
+        addToSignature(signatureText, contents.getChildFile("Info.plist"));
+        for (const auto &directory : contents.findChildFiles(File::findDirectories, false)) {
+            const auto name = directory.getFileName();
+            if (name != "MacOS" && !name.endsWith("-linux") && !name.endsWith("-win")) continue;
+
+            auto binaries = directory.findChildFiles(File::findFilesAndDirectories, false);
+            binaries.sort();
+            for (const auto &binary : binaries) {
+                signatureText << binary.getFileName() << '=';
+                addToSignature(signatureText, binary);
+            }
+        }
+    }
+    signature = signatureText.hashCode64();
+    return true;
+}
+
+bool PluginScanner::findCachedPluginTypesFor(const String &fileOrIdentifier, OwnedArray<PluginDescription> &result) {
+    int64 signature;
+    if (!getFileSignature(fileOrIdentifier, signature)) return false;
+
+    const ScopedLock scopedLock(lock);
+    const auto found = cache.find(fileOrIdentifier);
+    if (found == cache.end() || found->second->signature != signature)
+        return false;
+
+    for (const auto *description : found->second->descriptions)
+        result.add(new PluginDescription(*description));
+    return true;
+}
+
+void PluginScanner::cachePluginTypesFor(const String &fileOrIdentifier, const OwnedArray<PluginDescription> &result) {
+    auto entry = std::make_unique<CacheEntry>();
+    if (!getFileSignature(fileOrIdentifier, entry->signature)) return;
+
+    for (const auto *description : result)
+        entry->descriptions.add(new PluginDescription(*description));
+
+    const ScopedLock scopedLock(lock);
+    cache[fileOrIdentifier] = std::move(entry);
+    cacheChanged = true;
+}
+
+void PluginScanner::saveCache() {
+    XmlElement cacheXml("PLUGINSCANCACHE");
+    {
+        const ScopedLock scopedLock(lock);
+        if (!cacheChanged) return;
+
+        for (const auto &[path, entry] : cache) {
+            auto *fileXml = cacheXml.createNewChildElement("FILE");
+            fileXml->setAttribute("path", path);
+            fileXml->setAttribute("signature", String(entry->signature));
+            for (const auto *description : entry->descriptions)
+                fileXml->addChildElement(description->createXml().release());
+        }
+        cacheChanged = false;
+    }
+
+    // Scans finish on the message thread, so this is safe to do here.
+    getUserSettings()->setValue(PLUGIN_SCAN_CACHE_NAME, &cacheXml);
+    getApplicationProperties().saveIfNeeded();
+}
+
+PluginScannerChildProcess::PluginScannerChildProcess() {
+    formatManager.addDefaultFormats();
+}
+
+void PluginScannerChildProcess::handleMessageFromCoordinator(const MemoryBlock &message) {
+    MemoryInputStream request(message, false);
+    const auto formatName = request.readString();
+    const auto fileOrIdentifier = request.readString();
+
+    // Some plugin formats need to be loaded on the message thread.
+    MessageManager::callAsync([this, formatName, fileOrIdentifier] {
+        XmlElement reply("PLUGINS");
+        for (auto *format : formatManager.getFormats()) {
+            if (format->getName() == formatName) {
+                OwnedArray<PluginDescription> found;
+                format->findAllTypesForFile(found, fileOrIdentifier);
+                for (const auto *description : found)
+                    reply.addChildElement(description->createXml().release());
+            }
+        }
+        const auto replyString = reply.toString();
+        sendMessageToCoordinator(MemoryBlock(replyString.toRawUTF8(), replyString.getNumBytesAsUTF8()));
+    });
+}
+
+void PluginScannerChildProcess::handleConnectionLost() {
+    JUCEApplicationBase::quit();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+using namespace juce;
+
+// Scans plugin files in headless child processes (this app, launched with a scanner command line),
+// so a crashing plugin only takes down its own scanner process and gets blacklisted, instead of ending the scan.
+// `PluginListComponent` scans on several threads, and each thread gets a child process of its own.
+// Scan results are cached by file path and a signature of the file (or bundle) contents, so a rescan only loads plugins whose files changed.
+class PluginScanner : public KnownPluginList::CustomScanner {
+public:
+    PluginScanner();
+    ~PluginScanner() override;
+
+    bool findPluginTypesFor(AudioPluginFormat &format, OwnedArray<PluginDescription> &result, const String &fileOrIdentifier) override;
+    void scanFinished() override;
+
+    static constexpr const char *childProcessCommandLineUID = "flowGridPluginScanner";
+
+private:
+    struct ChildProcess;
+    struct CacheEntry {
+        int64 signature;
+        OwnedArray<PluginDescription> descriptions;
+    };
+
+    const String PLUGIN_SCAN_CACHE_NAME = "pluginScanCache";
+
+    CriticalSection lock;
+    OwnedArray<ChildProcess> idleChildProcesses;
+    std::map<String, std::unique_ptr<CacheEntry>> cache;
+    bool cacheChanged{false};
+
+    static bool getFileSignature(const String &fileOrIdentifier, int64 &signature);
+    bool findCachedPluginTypesFor(const String &fileOrIdentifier, OwnedArray<PluginDescription> &result);
+    void cachePluginTypesFor(const String &fileOrIdentifier, const OwnedArray<PluginDescription> &result);
+    void saveCache();
+};
+
+// The scanner side of a `PluginScanner` child process. Scans one file at a time on the message thread, and replies with what it found.
+struct PluginScannerChildProcess : public ChildProcessWorker {
+    PluginScannerChildProcess();
+
+    void handleMessageFromCoordinator(const MemoryBlock &message) override;
+    void handleConnectionLost() override;
+
+private:
+    AudioPluginFormatManager formatManager;
+};
@@ -2,15 +2,50 @@
 #include "push2/Push2MidiDevice.h"
 #include "processors/MidiInputProcessor.h"
 #include "processors/MidiOutputProcessor.h"
+#include "processors/OutOfProcessPluginInstance.h"
+#include "processors/TrackOutputProcessor.h"
 #include "action/CreateConnection.h"
 #include "action/UpdateProcessorDefaultConnections.h"
 #include "action/ResetDefaultExternalInputConnectionsAction.h"
 #include "action/DisconnectProcessor.h"
 
-ProcessorGraph::ProcessorGraph(AllProcessors &allProcessors, PluginManager &pluginManager, Tracks &tracks, Connections &connections, Input &input, Output &output, UndoManager &undoManager, AudioDeviceManager &deviceManager, Push2MidiCommunicator &push2MidiCommunicator)
-        : allProcessors(allProcessors), tracks(tracks), connections(connections), input(input), output(output),
+// Everything the plugin is created from is copied from the processor up front, since the processor can be destroyed meanwhile.
+struct ProcessorGraph::PendingInstantiation : public ThreadPoolJob {
+    PendingInstantiation(ProcessorGraph &graph, Processor *processor, std::unique_ptr<PluginDescription> description, bool createOnWorkerPool)
+            : ThreadPoolJob("Instantiate " + processor->getName()), processor(processor), createOnWorkerPool(createOnWorkerPool),
+              graph(graph), description(std::move(description)), stateBlob(processor->getProcessorStateBlob()), state(processor->getProcessorState()) {}
+
+    JobStatus runJob() override {
+        create();
+        graph.instantiationUpdater.triggerAsyncUpdate();
+        return jobHasFinished;
+    }
+
+    void create() {
+        audioProcessor = graph.createAudioProcessor(*description, stateBlob, state, errorMessage);
+        isCreated = true;
+    }
+
+    // Only accessed on the message thread. Cleared if the processor is destroyed before its plugin is added.
+    Processor *processor;
+    const bool createOnWorkerPool;
+    // Only read by the message thread once `isCreated` is set.
+    std::unique_ptr<AudioPluginInstance> audioProcessor;
+    String errorMessage;
+    std::atomic<bool> isCreated{false};
+
+private:
+    ProcessorGraph &graph;
+    const std::unique_ptr<PluginDescription> description;
+    const ProcessorStateBlob::Ptr stateBlob;
+    const String state;
+};
+
+ProcessorGraph::ProcessorGraph(AllProcessors &allProcessors, PluginManager &pluginManager, Tracks &tracks, Connections &connections, Input &input, Output &output, UndoManager &undoManager, AudioDeviceManager &deviceManager, Push2MidiCommunicator &push2MidiCommunicator, ThreadPool &workerPool)
+        : workerPool(workerPool), allProcessors(allProcessors), tracks(tracks), connections(connections), input(input), output(output),
           undoManager(undoManager), deviceManager(deviceManager), pluginManager(pluginManager), push2MidiCommunicator(push2MidiCommunicator) {
     enableAllBuses();
+    addChangeListener(this);
 
     tracks.addChildListener(this);
     tracks.addProcessorListener(this);
@@ -21,6 +56,10 @@ ProcessorGraph::ProcessorGraph(AllProcessors &allProcessors, PluginManager &plug
 }
 
 ProcessorGraph::~ProcessorGraph() {
+    for (auto *instantiation : pendingInstantiations)
+        workerPool.removeJob(instantiation, false, -1);
+    instantiationUpdater.cancelPendingUpdate();
+    removeChangeListener(this);
     output.removeStateListener(this);
     input.removeStateListener(this);
     connections.removeStateListener(this);
@@ -30,25 +69,165 @@ ProcessorGraph::~ProcessorGraph() {
 }
 
 void ProcessorGraph::addProcessor(Processor *processor) {
-    static String errorMessage = "Could not create processor";
+    auto removedNode = takeRemovedNode(processor);
+    if (auto *node = removedNode.node.get()) {
+        // Same as `addNode`, minus creating the node.
+        nodes.add(node);
+        if (lastNodeID.uid < node->nodeID.uid) lastNodeID = node->nodeID;
+        topologyChanged();
+        if (!processor->hasNodeId()) processor->setNodeId(node->nodeID);
+        initializeNode(processor, node, removedNode.stateInformation);
+        return;
+    }
+
+    String errorMessage;
     auto description = pluginManager.getDescriptionForIdentifier(processor->getId());
-    auto audioProcessor = pluginManager.getFormatManager().createPluginInstance(*description, getSampleRate(), getBlockSize(), errorMessage);
-    if (processor->hasProcessorState()) {
+    auto audioProcessor = description != nullptr ? createAudioProcessor(*description, processor->getProcessorStateBlob(), processor->getProcessorState(), errorMessage) : nullptr;
+    if (audioProcessor == nullptr) {
+        showCreationErrors({getCreationError(processor, errorMessage)});
+        return;
+    }
+    addAudioProcessor(processor, std::move(audioProcessor));
+}
+
+void ProcessorGraph::onProcessorCreated(Processor *processor) {
+    if (processorWrappers.getProcessorWrapperForProcessor(processor) == nullptr && findPendingInstantiation(processor) == nullptr)
+        addProcessor(processor);
+}
+
+void ProcessorGraph::onProcessorDestroyed(Processor *processor) {
+    if (auto *instantiation = findPendingInstantiation(processor))
+        instantiation->processor = nullptr; // Its plugin is dropped once it's created.
+    else
+        removeProcessor(processor);
+}
+
+void ProcessorGraph::addProcessors(const Array<Processor *> &processors) {
+    StringArray creationErrors;
+    for (auto *processor : processors) {
+        auto description = pluginManager.getDescriptionForIdentifier(processor->getId());
+        if (description == nullptr) {
+            creationErrors.add(getCreationError(processor, {}));
+            continue;
+        }
+
+        const bool createOnWorkerPool = pluginManager.canCreateInstanceOffMessageThread(*description);
+        auto *instantiation = pendingInstantiations.add(std::make_unique<PendingInstantiation>(*this, processor, std::move(description), createOnWorkerPool));
+        if (createOnWorkerPool) workerPool.addJob(instantiation, false);
+        numToInstantiate++;
+    }
+    showCreationErrors(creationErrors);
+    // Starts on the plugins that need the message thread.
+    if (!pendingInstantiations.isEmpty()) instantiationUpdater.triggerAsyncUpdate();
+}
+
+ProcessorGraph::PendingInstantiation *ProcessorGraph::findPendingInstantiation(const Processor *processor) const {
+    for (auto *instantiation : pendingInstantiations)
+        if (instantiation->processor == processor)
+            return instantiation;
+    return nullptr;
+}
+
+void ProcessorGraph::updatePendingInstantiations() {
+    // Create one plugin that needs the message thread per callback, so the app stays responsive meanwhile.
+    for (auto *instantiation : pendingInstantiations) {
+        if (!instantiation->createOnWorkerPool && !instantiation->isCreated) {
+            instantiation->create();
+            instantiationUpdater.triggerAsyncUpdate();
+            break;
+        }
+    }
+
+    for (int i = 0; i < pendingInstantiations.size();) {
+        auto *instantiation = pendingInstantiations.getUnchecked(i);
+        if (!instantiation->isCreated) {
+            i++;
+            continue;
+        }
+
+        // It may still be returning from its job.
+        if (instantiation->createOnWorkerPool) workerPool.removeJob(instantiation, false, -1);
+        if (auto *processor = instantiation->processor) {
+            if (instantiation->audioProcessor != nullptr) {
+                addAudioProcessor(processor, std::move(instantiation->audioProcessor));
+                addConnectionsForNode(processor->getNodeId());
+            } else {
+                pendingCreationErrors.add(getCreationError(processor, instantiation->errorMessage));
+            }
+        }
+        pendingInstantiations.remove(i);
+        numInstantiated++;
+    }
+
+    listeners.call([this](Listener &listener) { listener.processorInstantiationProgressChanged(numInstantiated, numToInstantiate); });
+    if (pendingInstantiations.isEmpty()) {
+        showCreationErrors(pendingCreationErrors);
+        pendingCreationErrors.clear();
+        numInstantiated = numToInstantiate = 0;
+    }
+}
+
+void ProcessorGraph::addConnectionsForNode(NodeID nodeId) {
+    // Connections loaded while the processor's plugin was still being created couldn't be added to the graph yet.
+    for (const auto *connection : connections.getChildren())
+        if (connection->getSourceNodeId() == nodeId || connection->getDestinationNodeId() == nodeId)
+            AudioProcessorGraph::addConnection(connection->toAudioConnection());
+}
+
+String ProcessorGraph::getCreationError(const Processor *processor, const String &errorMessage) {
+    return processor->getName() + ": " + (errorMessage.isNotEmpty() ? errorMessage : TRANS("Plugin not found"));
+}
+
+void ProcessorGraph::showCreationErrors(const StringArray &creationErrors) {
+    if (creationErrors.isEmpty()) return;
+
+    AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, TRANS("Could not create processor"), creationErrors.joinIntoString("\n"));
+}
+
+std::unique_ptr<AudioPluginInstance> ProcessorGraph::createAudioProcessor(const PluginDescription &description, const ProcessorStateBlob::Ptr &stateBlob,
+                                                                         const String &state, String &errorMessage) {
+    std::unique_ptr<AudioPluginInstance> audioProcessor;
+    if (pluginManager.shouldHostOutOfProcess(description)) {
+        auto outOfProcessPlugin = std::make_unique<OutOfProcessPluginInstance>(description, getSampleRate(), getBlockSize());
+        if (!outOfProcessPlugin->isLoaded()) {
+            errorMessage = outOfProcessPlugin->getErrorMessage();
+            return {};
+        }
+        audioProcessor = std::move(outOfProcessPlugin);
+    } else {
+        audioProcessor = pluginManager.getFormatManager().createPluginInstance(description, getSampleRate(), getBlockSize(), errorMessage);
+        if (audioProcessor == nullptr) return {};
+    }
+
+    if (stateBlob != nullptr) {
+        const ProcessorStateBlob::ScopedRead stateRead(*stateBlob);
+        audioProcessor->setStateInformation(stateRead.getData(), (int) stateRead.getSize());
+    } else if (state.isNotEmpty()) {
         MemoryBlock memoryBlock;
-        memoryBlock.fromBase64Encoding(processor->getProcessorState());
+        memoryBlock.fromBase64Encoding(state);
         audioProcessor->setStateInformation(memoryBlock.getData(), (int) memoryBlock.getSize());
     }
+    return audioProcessor;
+}
 
+void ProcessorGraph::addAudioProcessor(Processor *processor, std::unique_ptr<AudioPluginInstance> audioProcessor) {
     const Node::Ptr &newNode = processor->hasNodeId() ?
                                addNode(std::move(audioProcessor), processor->getNodeId()) :
                                addNode(std::move(audioProcessor));
     if (!processor->hasNodeId()) processor->setNodeId(newNode->nodeID);
-    processorWrappers.set(newNode->nodeID, std::make_unique<StatefulAudioProcessorWrapper>
-            (dynamic_cast<AudioPluginInstance *>(newNode->getProcessor()), processor, undoManager));
+    // The plugin was just restored from the processor's state blob, so it can be saved again as-is until anything changes.
+    initializeNode(processor, newNode.get(), processor->getProcessorStateBlob());
+}
+
+void ProcessorGraph::initializeNode(Processor *processor, Node *node, ProcessorStateBlob::Ptr stateInformation) {
+    auto processorWrapper = std::make_unique<StatefulAudioProcessorWrapper>(dynamic_cast<AudioPluginInstance *>(node->getProcessor()), processor, undoManager);
+    if (stateInformation != nullptr)
+        processorWrapper->setStateInformationCache(std::move(stateInformation));
+    processorWrappers.set(node->nodeID, std::move(processorWrapper));
     // Added the first processor. Start the timer that flushes new processor state to their value trees.
     if (processorWrappers.size() == 1) startTimerHz(10);
 
-    if (auto midiInputProcessor = dynamic_cast<MidiInputProcessor *>(newNode->getProcessor())) {
+    if (auto midiInputProcessor = dynamic_cast<MidiInputProcessor *>(node->getProcessor())) {
         const String &deviceName = processor->getDeviceName();
         midiInputProcessor->setDeviceName(deviceName);
         if (deviceName.containsIgnoreCase(Push2MidiDevice::getDeviceName())) {
@@ -56,7 +235,7 @@ void ProcessorGraph::addProcessor(Processor *processor) {
         } else {
             deviceManager.addMidiInputCallback(deviceName, &midiInputProcessor->getMidiMessageCollector());
         }
-    } else if (auto *midiOutputProcessor = dynamic_cast<MidiOutputProcessor *>(newNode->getProcessor())) {
+    } else if (auto *midiOutputProcessor = dynamic_cast<MidiOutputProcessor *>(node->getProcessor())) {
         const String &deviceName = processor->getDeviceName();
         if (auto *enabledMidiOutput = deviceManager.getEnabledMidiOutput(deviceName))
             midiOutputProcessor->setMidiOutput(enabledMidiOutput);
@@ -70,7 +249,11 @@ void ProcessorGraph::addProcessor(Processor *processor) {
 }
 
 void ProcessorGraph::removeProcessor(Processor *processor) {
+    // Never leave a suspended plugin instance behind, e.g. in the removed node pool.
+    unfreezeTracksUsingNode(processor->getNodeId());
     auto *processorWrapper = processorWrappers.getProcessorWrapperForProcessor(processor);
+    if (processorWrapper == nullptr) return; // Its plugin couldn't be created.
+
     const NodeID nodeId = processor->getNodeId();
     // disconnect should have already been called before delete! (to avoid nested undo actions)
     if (processor->getName() == MidiInputProcessor::name()) {
@@ -83,14 +266,396 @@ void ProcessorGraph::removeProcessor(Processor *processor) {
             }
         }
     }
+    // Only worth keeping around if it's already captured. Otherwise, only the processor state can be used to find it again.
+    ProcessorStateBlob::Ptr stateInformation;
+    if (!processorWrapper->isStateInformationDirty())
+        stateInformation = processorWrapper->getStateInformation();
     processorWrapper->audioProcessor->removeListener(processor);
     processorWrappers.erase(nodeId);
-    nodes.removeObject(AudioProcessorGraph::getNodeForId(nodeId));
+    if (Node::Ptr node = AudioProcessorGraph::getNodeForId(nodeId)) {
+        nodes.removeObject(node.get());
+        removedNodes.add({processor->getState(), std::move(stateInformation), node, getSampleRate(), getBlockSize()});
+        if (removedNodes.size() > MAX_REMOVED_NODES_TO_KEEP)
+            removedNodes.remove(0);
+    }
     topologyChanged();
     if (lastNodeID == nodeId)
         lastNodeID.uid -= 1;
 }
 
+ProcessorGraph::RemovedNode ProcessorGraph::takeRemovedNode(const Processor *processor) {
+    const auto *stateBlob = processor->getProcessorStateBlob();
+    for (int i = removedNodes.size() - 1; i >= 0; i--) {
+        const auto &removedNode = removedNodes.getReference(i);
+        // The very same processor state, or a copy of it (sharing its state blob).
+        const bool isSameProcessor = removedNode.processorState == processor->getState() ||
+                                     (stateBlob != nullptr && removedNode.stateInformation.get() == stateBlob &&
+                                      Processor::getId(removedNode.processorState) == processor->getId());
+        if (!isSameProcessor) continue;
+
+        const auto nodeId = removedNode.node->nodeID;
+        if (removedNode.sampleRate != getSampleRate() || removedNode.blockSize != getBlockSize()) {
+            // Prepared for different settings.
+            removedNodes.remove(i);
+            continue;
+        }
+        if ((processor->hasNodeId() && processor->getNodeId() != nodeId) || getNodeForId(nodeId) != nullptr) continue;
+
+        return removedNodes.removeAndReturn(i);
+    }
+    return {};
+}
+
+// Renders its track on the worker pool and hands the rendering to the Track Output once it's done.
+// Unfreezes its track on any change to it, except for UI-only changes, state captures, and changes to its (still live) Track Output.
+struct ProcessorGraph::FrozenTrack : private ValueTree::Listener, private AsyncUpdater, private ThreadPoolJob {
+    // `nodesToRender` are in dependency order, and `connectionsToRender` are all the graph's connections from them.
+    FrozenTrack(ProcessorGraph &graph, Track *track, ReferenceCountedArray<Node> nodesToRender, const std::vector<Connection> &connectionsToRender,
+                NodeID trackOutputNodeId, int numOutputChannels)
+            : ThreadPoolJob("Freeze track"), graph(graph), track(track), trackState(track->getState()),
+              sampleRate(graph.getSampleRate()), blockSize(graph.getBlockSize()),
+              nodesToRender(std::move(nodesToRender)), numOutputChannels(numOutputChannels) {
+        for (auto *node : this->nodesToRender)
+            suspendedNodeIds.add(node->nodeID);
+        for (const auto &connection : connectionsToRender)
+            renderConnections.push_back({suspendedNodeIds.indexOf(connection.source.nodeID), connection.source.channelIndex,
+                                         connection.destination.nodeID == trackOutputNodeId ? -1 : suspendedNodeIds.indexOf(connection.destination.nodeID),
+                                         connection.destination.channelIndex, connection.source.isMIDI()});
+        trackState.addListener(this);
+        graph.workerPool.addJob(this, false);
+    }
+
+    ~FrozenTrack() override {
+        stopRendering();
+        trackState.removeListener(this);
+    }
+
+    // Wait for the rendering to stop (early), so the suspended processors can be used again.
+    void stopRendering() { graph.workerPool.removeJob(this, true, -1); }
+    bool isRendering() const { return graph.workerPool.contains(this); }
+
+    ProcessorGraph &graph;
+    Track *track;
+    // The track's own tree (not a copy), so this can stop listening from within its own callbacks.
+    ValueTree &trackState;
+    Array<NodeID> suspendedNodeIds;
+    // The settings the suspended processors are rendered with.
+    const double sampleRate;
+    const int blockSize;
+
+private:
+    // A connection between indices into `nodesToRender` (with a destination index of -1 for the Track Output).
+    struct RenderConnection {
+        int sourceIndex, sourceChannel, destinationIndex, destinationChannel;
+        bool isMidi;
+    };
+
+    const ReferenceCountedArray<Node> nodesToRender;
+    std::vector<RenderConnection> renderConnections;
+    const int numOutputChannels;
+    std::unique_ptr<AudioBuffer<float>> rendering;
+
+    // Renders each node from what its connections feed it, the way the graph would, and collects what reaches the Track Output.
+    // The track gets no audio or MIDI from outside (see `canFreezeTrack`), so all of it is rendered from silence.
+    // The processors are suspended, so the audio thread leaves them alone.
+    JobStatus runJob() override {
+        const int numBlocks = jmax(1, roundToInt(FREEZE_LENGTH_SECONDS * sampleRate / blockSize));
+        AudioBuffer<float> renderBuffer(numOutputChannels, numBlocks * blockSize);
+        renderBuffer.clear();
+        OwnedArray<AudioBuffer<float>> nodeBuffers;
+        for (auto *node : nodesToRender) {
+            const auto *audioProcessor = node->getProcessor();
+            nodeBuffers.add(new AudioBuffer<float>(jmax(1, audioProcessor->getTotalNumInputChannels(), audioProcessor->getTotalNumOutputChannels()), blockSize));
+        }
+        std::vector<MidiBuffer> nodeMidiMessages((size_t) nodesToRender.size());
+
+        for (int block = 0; block < numBlocks; block++) {
+            if (shouldExit()) return jobHasFinished;
+
+            for (int i = 0; i < nodesToRender.size(); i++) {
+                auto *node = nodesToRender.getUnchecked(i);
+                auto &buffer = *nodeBuffers.getUnchecked(i);
+                auto &midiMessages = nodeMidiMessages[(size_t) i];
+                buffer.clear();
+                midiMessages.clear();
+                for (const auto &connection : renderConnections) {
+                    if (connection.destinationIndex != i) continue;
+
+                    if (connection.isMidi)
+                        midiMessages.addEvents(nodeMidiMessages[(size_t) connection.sourceIndex], 0, blockSize, 0);
+                    else if (connection.destinationChannel < buffer.getNumChannels())
+                        addChannel(buffer, connection.destinationChannel, *nodeBuffers.getUnchecked(connection.sourceIndex), connection.sourceChannel, 0);
+                }
+                if (node->isBypassed())
+                    node->getProcessor()->processBlockBypassed(buffer, midiMessages);
+                else
+                    node->getProcessor()->processBlock(buffer, midiMessages);
+            }
+            for (const auto &connection : renderConnections)
+                if (connection.destinationIndex == -1 && !connection.isMidi && connection.destinationChannel < numOutputChannels)
+                    addChannel(renderBuffer, connection.destinationChannel, *nodeBuffers.getUnchecked(connection.sourceIndex), connection.sourceChannel, block * blockSize);
+        }
+        rendering = std::make_unique<AudioBuffer<float>>(std::move(renderBuffer));
+        triggerAsyncUpdate();
+        return jobHasFinished;
+    }
+
+    void addChannel(AudioBuffer<float> &destination, int destinationChannel, const AudioBuffer<float> &source, int sourceChannel, int destinationStartSample) const {
+        if (sourceChannel < source.getNumChannels())
+            destination.addFrom(destinationChannel, destinationStartSample, source, sourceChannel, 0, blockSize);
+    }
+
+    void handleAsyncUpdate() override {
+        if (auto *trackOutput = graph.getTrackOutputProcessor(track))
+            trackOutput->setFrozenAudio(std::move(rendering));
+    }
+
+    bool isInTrackOutput(ValueTree tree) const {
+        const auto *trackOutput = track->getOutputProcessor();
+        for (; tree.isValid() && tree != trackState; tree = tree.getParent())
+            if (trackOutput != nullptr && tree == trackOutput->getState())
+                return true;
+        return false;
+    }
+
+    // Note that unfreezing deletes this object.
+    void unfreezeIfEdited(const ValueTree &tree) {
+        if (!isInTrackOutput(tree))
+            graph.unfreezeTrack(track);
+    }
+
+    void valueTreePropertyChanged(ValueTree &tree, const Identifier &i) override {
+        if (i == TrackIDs::selected || i == TrackIDs::name || i == TrackIDs::colour || i == ProcessorLaneIDs::selectedSlotsMask ||
+            i == ProcessorIDs::state || i == ProcessorIDs::stateBlob || i == ProcessorIDs::pluginWindowType ||
+            i == ProcessorIDs::pluginWindowX || i == ProcessorIDs::pluginWindowY)
+            return;
+        unfreezeIfEdited(tree);
+    }
+    void valueTreeChildAdded(ValueTree &parent, ValueTree &) override { unfreezeIfEdited(parent); }
+    void valueTreeChildRemoved(ValueTree &parent, ValueTree &, int) override { unfreezeIfEdited(parent); }
+    void valueTreeChildOrderChanged(ValueTree &parent, int, int) override { unfreezeIfEdited(parent); }
+};
+
+TrackOutputProcessor *ProcessorGraph::getTrackOutputProcessor(const Track *track) const {
+    const auto *outputProcessor = track->getOutputProcessor();
+    return outputProcessor != nullptr ? dynamic_cast<TrackOutputProcessor *>(processorWrappers.getAudioProcessorForProcessor(outputProcessor)) : nullptr;
+}
+
+Array<Processor *> ProcessorGraph::getProcessorsToFreeze(const Track *track) const {
+    Array<Processor *> processors;
+    if (auto *trackInput = track->getInputProcessor())
+        processors.add(trackInput);
+    processors.addArray(track->getProcessorLane()->getChildren());
+    return processors;
+}
+
+bool ProcessorGraph::canFreezeTrack(const Track *track) const {
+    if (track == nullptr || track->isMaster() || isTrackFrozen(track) || !isRenderingPrepared || getSampleRate() <= 0 || getBlockSize() <= 0 ||
+        getTrackOutputProcessor(track) == nullptr)
+        return false;
+
+    Array<NodeID> nodeIdsToFreeze;
+    bool consumesMidi = false;
+    for (const auto *processor : getProcessorsToFreeze(track)) {
+        // Its plugin isn't in the graph (yet).
+        auto *node = getNodeForId(processor->getNodeId());
+        if (node == nullptr) return false;
+
+        nodeIdsToFreeze.add(node->nodeID);
+        const auto *audioProcessor = node->getProcessor();
+        consumesMidi |= audioProcessor->acceptsMidi() && !audioProcessor->isMidiEffect();
+    }
+
+    // Only tracks wired up by default connections alone are frozen.
+    const auto trackOutputNodeId = track->getOutputProcessor()->getNodeId();
+    for (const auto *connection : connections.getChildren()) {
+        const auto sourceNodeId = connection->getSourceNodeId(), destinationNodeId = connection->getDestinationNodeId();
+        if (connection->isCustom() && (nodeIdsToFreeze.contains(sourceNodeId) || nodeIdsToFreeze.contains(destinationNodeId) || destinationNodeId == trackOutputNodeId))
+            return false;
+    }
+
+    for (const auto &connection : getConnections()) {
+        const bool isFromTrack = nodeIdsToFreeze.contains(connection.source.nodeID);
+        const bool isIntoTrack = nodeIdsToFreeze.contains(connection.destination.nodeID) || connection.destination.nodeID == trackOutputNodeId;
+        // Sends to other tracks would go silent while the processors feeding them are suspended.
+        if (isFromTrack && !isIntoTrack) return false;
+        if (isIntoTrack && !isFromTrack) {
+            // The rendering starts from silence, so audio from outside the track (an audio input, or another track's send)
+            // can't be rendered ahead of time. Neither can live MIDI played on an instrument (or anything else consuming MIDI
+            // rather than passing it on).
+            if (!connection.destination.isMIDI() || consumesMidi) return false;
+        }
+    }
+    return true;
+}
+
+bool ProcessorGraph::freezeTrack(Track *track) {
+    if (!canFreezeTrack(track)) return false;
+
+    Array<NodeID> nodeIdsToFreeze;
+    for (const auto *processor : getProcessorsToFreeze(track))
+        nodeIdsToFreeze.add(processor->getNodeId());
+
+    std::vector<Connection> connectionsToRender;
+    for (const auto &connection : getConnections())
+        if (nodeIdsToFreeze.contains(connection.source.nodeID))
+            connectionsToRender.push_back(connection);
+
+    // Dependency order: each node after all the track's nodes feeding it. (The graph has no feedback loops.)
+    ReferenceCountedArray<Node> nodesToRender;
+    Array<NodeID> renderedNodeIds;
+    while (renderedNodeIds.size() < nodeIdsToFreeze.size()) {
+        const int numRenderedNodes = renderedNodeIds.size();
+        for (const auto nodeId : nodeIdsToFreeze) {
+            if (renderedNodeIds.contains(nodeId)) continue;
+
+            const bool isFedByUnrenderedNode = std::any_of(connectionsToRender.begin(), connectionsToRender.end(), [&](const Connection &connection) {
+                return connection.destination.nodeID == nodeId && !renderedNodeIds.contains(connection.source.nodeID);
+            });
+            if (isFedByUnrenderedNode) continue;
+
+            auto *node = getNodeForId(nodeId);
+            // Once this returns, the audio thread is done with it, so it can be rendered on the worker pool.
+            node->getProcessor()->suspendProcessing(true);
+            nodesToRender.add(node);
+            renderedNodeIds.add(nodeId);
+        }
+        if (renderedNodeIds.size() == numRenderedNodes) {
+            jassertfalse;
+            break;
+        }
+    }
+
+    // The track is silent until its rendering is done.
+    const auto trackOutputNodeId = track->getOutputProcessor()->getNodeId();
+    frozenTracks.add(new FrozenTrack(*this, track, std::move(nodesToRender), connectionsToRender, trackOutputNodeId,
+                                     getTrackOutputProcessor(track)->getTotalNumInputChannels()));
+    return true;
+}
+
+void ProcessorGraph::unfreezeTrack(Track *track) {
+    for (int i = frozenTracks.size() - 1; i >= 0; i--) {
+        auto *frozenTrack = frozenTracks.getUnchecked(i);
+        if (frozenTrack->track != track) continue;
+
+        frozenTrack->stopRendering();
+        if (auto *trackOutput = getTrackOutputProcessor(track))
+            trackOutput->setFrozenAudio(nullptr);
+        for (const auto nodeId : frozenTrack->suspendedNodeIds)
+            if (auto *node = getNodeForId(nodeId))
+                node->getProcessor()->suspendProcessing(false);
+        frozenTracks.remove(i);
+    }
+}
+
+bool ProcessorGraph::isTrackFrozen(const Track *track) const {
+    for (const auto *frozenTrack : frozenTracks)
+        if (frozenTrack->track == track)
+            return true;
+    return false;
+}
+
+void ProcessorGraph::unfreezeTracksUsingNode(NodeID nodeId) {
+    for (int i = frozenTracks.size() - 1; i >= 0; i--)
+        if (auto *frozenTrack = frozenTracks[i])
+            if (frozenTrack->suspendedNodeIds.contains(nodeId))
+                unfreezeTrack(frozenTrack->track);
+}
+
+void ProcessorGraph::unfreezeTracksRenderedWithOtherSettings() {
+    for (int i = frozenTracks.size() - 1; i >= 0; i--)
+        if (auto *frozenTrack = frozenTracks[i])
+            if (frozenTrack->sampleRate != getSampleRate() || frozenTrack->blockSize != getBlockSize())
+                unfreezeTrack(frozenTrack->track);
+}
+
+void ProcessorGraph::prepareToPlay(double sampleRate, int estimatedSamplesPerBlock) {
+    if (isRenderingPrepared && (sampleRate != getSampleRate() || estimatedSamplesPerBlock != getBlockSize()))
+        releaseResources();
+
+    setRateAndBufferSizeDetails(sampleRate, estimatedSamplesPerBlock);
+    isRenderingPrepared = true;
+    if (MessageManager::getInstance()->isThisTheMessageThread())
+        rebuildRenderSequence();
+    else
+        renderSequenceUpdater.triggerAsyncUpdate();
+}
+
+void ProcessorGraph::releaseResources() {
+    isRenderingPrepared = false;
+    std::unique_ptr<GraphRenderSequence> oldRenderSequence;
+    {
+        const ScopedLock callbackLock(getCallbackLock());
+        std::swap(renderSequence, oldRenderSequence);
+    }
+    // Nodes are only ever (un)prepared on the message thread.
+    if (MessageManager::getInstance()->isThisTheMessageThread())
+        releaseNodes();
+    else
+        renderSequenceUpdater.triggerAsyncUpdate();
+}
+
+void ProcessorGraph::releaseNodes() {
+    // Its processors are about to be released, so the rendering couldn't finish.
+    for (int i = frozenTracks.size() - 1; i >= 0; i--)
+        if (auto *frozenTrack = frozenTracks[i])
+            if (frozenTrack->isRendering())
+                unfreezeTrack(frozenTrack->track);
+    for (auto *node : preparedNodes)
+        node->getProcessor()->releaseResources();
+    preparedNodes.clear();
+}
+
+void ProcessorGraph::processBlock(AudioBuffer<float> &buffer, MidiBuffer &midiMessages) {
+    const ScopedLock callbackLock(getCallbackLock());
+    if (renderSequence != nullptr) {
+        renderSequence->perform(buffer, midiMessages, getPlayHead());
+    } else {
+        buffer.clear();
+        midiMessages.clear();
+    }
+}
+
+void ProcessorGraph::prepareNodes() {
+    // The settings may have changed on another thread since the nodes were prepared.
+    if (preparedSampleRate != getSampleRate() || preparedBlockSize != getBlockSize()) {
+        releaseNodes();
+        preparedSampleRate = getSampleRate();
+        preparedBlockSize = getBlockSize();
+    }
+    for (auto *node : getNodes()) {
+        if (preparedNodes.contains(node)) continue;
+
+        auto *processor = node->getProcessor();
+        if (auto *ioProcessor = dynamic_cast<AudioGraphIOProcessor *>(processor))
+            ioProcessor->setParentGraph(this);
+        processor->setRateAndBufferSizeDetails(getSampleRate(), getBlockSize());
+        processor->prepareToPlay(getSampleRate(), getBlockSize());
+        preparedNodes.add(node);
+    }
+    for (int i = preparedNodes.size() - 1; i >= 0; i--) {
+        auto *node = preparedNodes.getObjectPointerUnchecked(i);
+        const bool isRemovedNode = std::any_of(removedNodes.begin(), removedNodes.end(), [node](const RemovedNode &removedNode) { return removedNode.node.get() == node; });
+        if (!getNodes().contains(node) && !isRemovedNode)
+            preparedNodes.remove(i);
+    }
+}
+
+void ProcessorGraph::rebuildRenderSequence() {
+    if (!isRenderingPrepared) return;
+
+    // Before re-preparing any processors a frozen track is still being rendered with.
+    unfreezeTracksRenderedWithOtherSettings();
+    prepareNodes();
+    auto newRenderSequence = std::make_unique<GraphRenderSequence>(*this, getBlockSize());
+    setLatencySamples(newRenderSequence->getLatencySamples());
+    {
+        const ScopedLock callbackLock(getCallbackLock());
+        std::swap(renderSequence, newRenderSequence);
+    }
+    // The old sequence (and any nodes only it still refers to) is freed here, outside the audio callback.
+}
+
 bool ProcessorGraph::canAddConnection(const Connection &c) {
     if (auto *source = getNodeForId(c.source.nodeID))
         if (auto *dest = getNodeForId(c.destination.nodeID))
@@ -183,10 +748,15 @@ void ProcessorGraph::updateIoChannelEnabled(const ValueTree &channels, const Val
 
 void ProcessorGraph::resumeAudioGraphUpdatesAndApplyDiffSincePause() {
     graphUpdatesArePaused = false;
-    for (auto *connection : connectionsSincePause.connectionsToDelete)
-        valueTreeChildRemoved(connections.getState(), connection->getState(), 0);
-    for (auto *connection : connectionsSincePause.connectionsToCreate)
-        valueTreeChildAdded(connections.getState(), connection->getState());
+    // Replay the diff through the same listener callbacks the connection state changes go through when not paused.
+    for (const auto &connectionToDelete : connectionsSincePause.connectionsToDelete) {
+        fg::Connection connection(connectionToDelete.connection, !connectionToDelete.isCustom);
+        onChildRemoved(&connection, 0);
+    }
+    for (const auto &connectionToCreate : connectionsSincePause.connectionsToCreate) {
+        fg::Connection connection(connectionToCreate.connection, !connectionToCreate.isCustom);
+        onChildAdded(&connection);
+    }
     connectionsSincePause.connectionsToDelete.clear();
     connectionsSincePause.connectionsToCreate.clear();
 }
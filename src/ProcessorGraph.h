@@ -10,18 +10,30 @@
 #include "model/Connections.h"
 #include "model/StatefulAudioProcessorWrappers.h"
 #include "PluginManager.h"
+#include "GraphRenderSequence.h"
 
 using namespace fg; // Only to disambiguate `Connection` currently
 
+class TrackOutputProcessor;
+
 struct ProcessorGraph : public AudioProcessorGraph,
                         private ValueTree::Listener, StatefulList<Track>::Listener, StatefulList<Processor>::Listener, StatefulList<fg::Connection>::Listener,
-                        private Timer {
+                        private ChangeListener, private Timer {
     explicit ProcessorGraph(AllProcessors &allProcessors, PluginManager &pluginManager, Tracks &tracks, Connections &connections,
                             Input &input, Output &output, UndoManager &undoManager, AudioDeviceManager &deviceManager,
-                            Push2MidiCommunicator &push2MidiCommunicator);
+                            Push2MidiCommunicator &push2MidiCommunicator, ThreadPool &workerPool);
 
     ~ProcessorGraph() override;
 
+    struct Listener {
+        virtual ~Listener() = default;
+        // Called on the message thread while `addProcessors` instantiates plugins. It's done once `numInstantiated == numToInstantiate`.
+        virtual void processorInstantiationProgressChanged(int numInstantiated, int numToInstantiate) = 0;
+    };
+
+    void addListener(Listener *listener) { listeners.add(listener); }
+    void removeListener(Listener *listener) { listeners.remove(listener); }
+
     StatefulAudioProcessorWrappers &getProcessorWrappers() { return processorWrappers; }
 
     void pauseAudioGraphUpdates() { graphUpdatesArePaused = true; }
@@ -44,17 +56,41 @@ struct ProcessorGraph : public AudioProcessorGraph,
     bool doDisconnectNode(const Processor *processor, ConnectionType connectionType,
                           bool defaults, bool custom, bool incoming, bool outgoing, NodeID excludingRemovalTo = {});
 
-    void onProcessorCreated(Processor *processor) {
-        if (processorWrappers.getProcessorWrapperForProcessor(processor) == nullptr)
-            addProcessor(processor);
-    }
-
-    void onProcessorDestroyed(Processor *processor) {
-        removeProcessor(processor);
-    }
+    void onProcessorCreated(Processor *processor);
+    void onProcessorDestroyed(Processor *processor);
+
+    // Instantiate all given processors (e.g. everything in a freshly loaded project) without blocking the message thread.
+    // Plugins that can be created off the message thread (internal ones, and plugins hosted out of process)
+    // are created and state-restored on the worker pool, while the rest are created on the message thread one at a time,
+    // each in its own async callback. Each plugin joins the graph (along with its connections) as soon as it's created.
+    // Processors whose plugin can't be created are left out of the graph, and listed in a warning once all are done.
+    void addProcessors(const Array<Processor *> &processors);
+    bool isInstantiatingProcessors() const { return !pendingInstantiations.isEmpty(); }
+
+    // Render everything on the track up to its Track Output offline (on the worker pool), and from then on play that
+    // rendering (looped) through the Track Output instead, with all the track's other processors suspended.
+    // Any edit to the track (or a change of sample rate or block size) unfreezes it again, and so does unfreezing it
+    // while it's still being rendered.
+    // The rendering follows the graph's connections between the track's processors.
+    // Only tracks wired by default connections alone, with no audio from outside the track, no sends to other tracks,
+    // and no live MIDI from outside played on an instrument, can be frozen.
+    bool canFreezeTrack(const Track *track) const;
+    bool freezeTrack(Track *track);
+    void unfreezeTrack(Track *track);
+    bool isTrackFrozen(const Track *track) const;
+
+    // The graph is rendered by its own `GraphRenderSequence` rather than the stock one, which prepares all nodes itself.
+    void prepareToPlay(double sampleRate, int estimatedSamplesPerBlock) override;
+    void releaseResources() override;
+    void processBlock(AudioBuffer<float> &buffer, MidiBuffer &midiMessages) override;
+    using AudioProcessorGraph::processBlock;
+    bool supportsDoublePrecisionProcessing() const override { return false; }
 
 private:
-    StatefulAudioProcessorWrappers processorWrappers;
+    // Shared with the rest of the app.
+    ThreadPool &workerPool;
+    StatefulAudioProcessorWrappers processorWrappers{workerPool};
+    ListenerList<Listener> listeners;
 
     AllProcessors &allProcessors;
     Tracks &tracks;
@@ -69,9 +105,85 @@ private:
 
     bool graphUpdatesArePaused{false};
 
+    std::unique_ptr<GraphRenderSequence> renderSequence;
+    std::atomic<bool> isRenderingPrepared{false};
+    // Nodes whose processors have been prepared for `preparedSampleRate` & `preparedBlockSize` (including removed ones still kept around).
+    // Only accessed on the message thread.
+    ReferenceCountedArray<Node> preparedNodes;
+    double preparedSampleRate{0};
+    int preparedBlockSize{0};
+
+    void prepareNodes();
+    void releaseNodes();
+    void rebuildRenderSequence();
+
+    // Rebuilds the render sequence (or releases the nodes) on the message thread, after the graph was prepared
+    // (or released) on another thread.
+    // (`AudioProcessorGraph` is already a (private) `AsyncUpdater`, for the stock render sequence.)
+    struct RenderSequenceUpdater : public AsyncUpdater {
+        explicit RenderSequenceUpdater(ProcessorGraph &graph) : graph(graph) {}
+        void handleAsyncUpdate() override {
+            if (graph.isRenderingPrepared)
+                graph.rebuildRenderSequence();
+            else
+                graph.releaseNodes();
+        }
+
+    private:
+        ProcessorGraph &graph;
+    } renderSequenceUpdater{*this};
+
+    // Nodes of recently removed processors, with their plugin instances still alive and prepared,
+    // so that re-adding the same processor (e.g. undoing its deletion) doesn't need to re-create the plugin. Oldest first.
+    struct RemovedNode {
+        ValueTree processorState;
+        ProcessorStateBlob::Ptr stateInformation;
+        Node::Ptr node;
+        double sampleRate{0};
+        int blockSize{0};
+    };
+    Array<RemovedNode> removedNodes;
+    static constexpr int MAX_REMOVED_NODES_TO_KEEP = 8;
+
+    RemovedNode takeRemovedNode(const Processor *processor);
+
+    struct FrozenTrack;
+    OwnedArray<FrozenTrack> frozenTracks;
+    static constexpr double FREEZE_LENGTH_SECONDS = 8.0;
+
+    TrackOutputProcessor *getTrackOutputProcessor(const Track *track) const;
+    Array<Processor *> getProcessorsToFreeze(const Track *track) const;
+    void unfreezeTracksUsingNode(NodeID nodeId);
+    void unfreezeTracksRenderedWithOtherSettings();
+
     CreateOrDeleteConnections connectionsSincePause{connections};
 
+    // A processor whose plugin `addProcessors` is still creating.
+    struct PendingInstantiation;
+    OwnedArray<PendingInstantiation> pendingInstantiations;
+    int numInstantiated{0}, numToInstantiate{0};
+    StringArray pendingCreationErrors;
+
+    // Adds the plugins created on the worker pool to the graph, and creates the next one that needs the message thread.
+    struct InstantiationUpdater : public AsyncUpdater {
+        explicit InstantiationUpdater(ProcessorGraph &graph) : graph(graph) {}
+        void handleAsyncUpdate() override { graph.updatePendingInstantiations(); }
+
+    private:
+        ProcessorGraph &graph;
+    } instantiationUpdater{*this};
+
+    PendingInstantiation *findPendingInstantiation(const Processor *processor) const;
+    void updatePendingInstantiations();
+
     void addProcessor(Processor *processor);
+    std::unique_ptr<AudioPluginInstance> createAudioProcessor(const PluginDescription &description, const ProcessorStateBlob::Ptr &stateBlob,
+                                                              const String &state, String &errorMessage);
+    void addAudioProcessor(Processor *processor, std::unique_ptr<AudioPluginInstance> audioProcessor);
+    static String getCreationError(const Processor *processor, const String &errorMessage);
+    static void showCreationErrors(const StringArray &creationErrors);
+    void initializeNode(Processor *processor, Node *node, ProcessorStateBlob::Ptr stateInformation);
+    void addConnectionsForNode(NodeID nodeId);
     void removeProcessor(Processor *processor);
 
     bool canAddConnection(Node *source, int sourceChannel, Node *dest, int destChannel);
@@ -79,7 +191,7 @@ private:
     void updateIoChannelEnabled(const ValueTree &channels, const ValueTree &channel, bool enabled);
 
     void onChildAdded(Track *) override {}
-    void onChildRemoved(Track *, int oldIndex) override {}
+    void onChildRemoved(Track *track, int oldIndex) override { unfreezeTrack(track); }
     void onChildChanged(Track *, const Identifier &i) override {}
 
     void onChildAdded(Processor *) override {}
@@ -92,14 +204,18 @@ private:
         }
     }
     void onChildAdded(fg::Connection *connection) override {
+        unfreezeTracksUsingNode(connection->getSourceNodeId());
+        unfreezeTracksUsingNode(connection->getDestinationNodeId());
         if (graphUpdatesArePaused)
             connectionsSincePause.addConnection(connection->toAudioConnection(), !connection->isCustom());
         else
             AudioProcessorGraph::addConnection(connection->toAudioConnection());
     }
     void onChildRemoved(fg::Connection *connection, int oldIndex) override {
+        unfreezeTracksUsingNode(connection->getSourceNodeId());
+        unfreezeTracksUsingNode(connection->getDestinationNodeId());
         if (graphUpdatesArePaused)
-            connectionsSincePause.removeConnection(connection->toAudioConnection());
+            connectionsSincePause.removeConnection(connection->toAudioConnection(), connection->isCustom());
         else
             AudioProcessorGraph::removeConnection(connection->toAudioConnection());
     }
@@ -108,5 +224,10 @@ private:
     void valueTreeChildAdded(ValueTree &parent, ValueTree &child) override;
     void valueTreeChildRemoved(ValueTree &parent, ValueTree &child, int indexFromWhichChildWasRemoved) override;
 
+    // Topology changes
+    void changeListenerCallback(ChangeBroadcaster *source) override {
+        if (source == this) rebuildRenderSequence();
+    }
+
     void timerCallback() override;
 };
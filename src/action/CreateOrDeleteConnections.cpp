@@ -15,10 +15,10 @@ CreateOrDeleteConnections::CreateOrDeleteConnections(CreateOrDeleteConnections *
 bool CreateOrDeleteConnections::perform() {
     if (connectionsToCreate.isEmpty() && connectionsToDelete.isEmpty()) return false;
 
-    for (auto *connectionToDelete : connectionsToDelete)
-        connections.removeAudioConnection(connectionToDelete->toAudioConnection());
-    for (auto *connectionToCreate : connectionsToCreate)
-        connections.append(connectionToCreate);
+    for (const auto &connectionToDelete : connectionsToDelete)
+        connections.removeAudioConnection(connectionToDelete.connection);
+    for (const auto &connectionToCreate : connectionsToCreate)
+        connections.append(connectionToCreate.connection, !connectionToCreate.isCustom);
     return true;
 }
 
@@ -26,9 +26,11 @@ bool CreateOrDeleteConnections::undo() {
     if (connectionsToCreate.isEmpty() && connectionsToDelete.isEmpty()) return false;
 
     for (int i = connectionsToCreate.size() - 1; i >= 0; i--)
-        connections.removeAudioConnection(connectionsToCreate.getUnchecked(i)->toAudioConnection());
-    for (int i = connectionsToDelete.size() - 1; i >= 0; i--)
-        connections.append(connectionsToDelete.getUnchecked(i));
+        connections.removeAudioConnection(connectionsToCreate.getReference(i).connection);
+    for (int i = connectionsToDelete.size() - 1; i >= 0; i--) {
+        const auto &connectionToDelete = connectionsToDelete.getReference(i);
+        connections.append(connectionToDelete.connection, !connectionToDelete.isCustom);
+    }
     return true;
 }
 
@@ -40,17 +42,15 @@ UndoableAction *CreateOrDeleteConnections::createCoalescedAction(UndoableAction
 }
 
 void CreateOrDeleteConnections::coalesceWith(const CreateOrDeleteConnections &other) {
-    for (const auto *connectionToCreate : other.connectionsToCreate)
-        addConnection(connectionToCreate->toAudioConnection(), !connectionToCreate->isCustom());
-    for (const auto *connectionToDelete : other.connectionsToDelete)
-        removeConnection(connectionToDelete->toAudioConnection());
+    for (const auto &connectionToCreate : other.connectionsToCreate)
+        addConnection(connectionToCreate.connection, !connectionToCreate.isCustom);
+    for (const auto &connectionToDelete : other.connectionsToDelete)
+        removeConnection(connectionToDelete.connection, connectionToDelete.isCustom);
 }
 
-static int indexOf(OwnedArray<fg::Connection> &connections, const AudioProcessorGraph::Connection &audioConnection) {
-    for (int i = 0; i < connections.size(); i++) {
-        const auto *connection = connections.getUnchecked(i);
-        if (connection->toAudioConnection() == audioConnection) return i;
-    }
+static int indexOf(const Array<CreateOrDeleteConnections::ConnectionRecord> &connections, const AudioProcessorGraph::Connection &audioConnection) {
+    for (int i = 0; i < connections.size(); i++)
+        if (connections.getReference(i).connection == audioConnection) return i;
     return -1;
 }
 
@@ -61,20 +61,19 @@ void CreateOrDeleteConnections::addConnection(const AudioProcessorGraph::Connect
     } else {
         int createIndex = indexOf(connectionsToCreate, audioConnection);
         if (createIndex == -1) {
-            connectionsToCreate.add(std::make_unique<fg::Connection>(audioConnection, isDefault));
+            connectionsToCreate.add({audioConnection, !isDefault});
         }
     }
 }
 
-void CreateOrDeleteConnections::removeConnection(const AudioProcessorGraph::Connection &audioConnection) {
+void CreateOrDeleteConnections::removeConnection(const AudioProcessorGraph::Connection &audioConnection, bool isCustom) {
     int createIndex = indexOf(connectionsToCreate, audioConnection);
     if (createIndex != -1) {
         connectionsToCreate.remove(createIndex); // cancels out
     } else {
         int deleteIndex = indexOf(connectionsToDelete, audioConnection);
         if (deleteIndex == -1) {
-            connectionsToDelete.add(std::make_unique<fg::Connection>(audioConnection));
+            connectionsToDelete.add({audioConnection, isCustom});
         }
     }
-
 }
@@ -3,6 +3,12 @@
 #include "model/Connections.h"
 
 struct CreateOrDeleteConnections : public UndoableAction {
+    // Plain value record of a connection, so undo history doesn't hold on to a `ValueTree` per connection.
+    struct ConnectionRecord {
+        AudioProcessorGraph::Connection connection;
+        bool isCustom;
+    };
+
     explicit CreateOrDeleteConnections(Connections &connections);
 
     CreateOrDeleteConnections(CreateOrDeleteConnections *coalesceLeft, CreateOrDeleteConnections *coalesceRight, Connections &connections);
@@ -10,16 +16,16 @@ struct CreateOrDeleteConnections : public UndoableAction {
     bool perform() override;
     bool undo() override;
 
-    int getSizeInUnits() override { return (int) sizeof(*this); }
+    int getSizeInUnits() override { return (int) (sizeof(*this) + size_t(connectionsToCreate.size() + connectionsToDelete.size()) * sizeof(ConnectionRecord)); }
 
     UndoableAction *createCoalescedAction(UndoableAction *nextAction) override;
     void coalesceWith(const CreateOrDeleteConnections &other);
 
     void addConnection(const AudioProcessorGraph::Connection &connection, bool isDefault);
-    void removeConnection(const AudioProcessorGraph::Connection &connection);
+    void removeConnection(const AudioProcessorGraph::Connection &connection, bool isCustom);
 
-    OwnedArray<fg::Connection> connectionsToCreate;
-    OwnedArray<fg::Connection> connectionsToDelete;
+    Array<ConnectionRecord> connectionsToCreate;
+    Array<ConnectionRecord> connectionsToDelete;
 protected:
     Connections &connections;
 };
@@ -7,5 +7,5 @@ static bool canRemoveConnection(const fg::Connection *connection, bool allowDefa
 DeleteConnection::DeleteConnection(const fg::Connection *connection, bool allowCustom, bool allowDefaults, Connections &connections)
         : CreateOrDeleteConnections(connections) {
     if (canRemoveConnection(connection, allowDefaults, allowCustom))
-        removeConnection(connection->toAudioConnection());
+        removeConnection(connection->toAudioConnection(), connection->isCustom());
 }
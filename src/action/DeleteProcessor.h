@@ -14,7 +14,11 @@ struct DeleteProcessor : public UndoableAction {
     bool performTemporary(bool apply=false);
     bool undoTemporary(bool apply=false);
 
-    int getSizeInUnits() override { return (int) sizeof(*this); }
+    // Most of the weight is in the saved plugin state.
+    int getSizeInUnits() override {
+        const auto *stateBlob = dynamic_cast<ProcessorStateBlob *>(processorState[ProcessorIDs::stateBlob].getObject());
+        return (int) (sizeof(*this) + (stateBlob != nullptr ? stateBlob->getSize() : 0)) + disconnectProcessorAction.getSizeInUnits();
+    }
 
 private:
     int trackIndex, processorSlot, processorIndex, pluginWindowType;
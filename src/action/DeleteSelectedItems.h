@@ -10,7 +10,14 @@ struct DeleteSelectedItems : public UndoableAction {
     bool perform() override;
     bool undo() override;
 
-    int getSizeInUnits() override { return (int) sizeof(*this); }
+    int getSizeInUnits() override {
+        int size = (int) sizeof(*this);
+        for (auto *deleteTrackAction : deleteTrackActions)
+            size += deleteTrackAction->getSizeInUnits();
+        for (auto *deleteProcessorAction : deleteProcessorActions)
+            size += deleteProcessorAction->getSizeInUnits();
+        return size;
+    }
 
 private:
     OwnedArray<DeleteTrack> deleteTrackActions;
@@ -10,7 +10,12 @@ struct DeleteTrack : public UndoableAction {
     bool perform() override;
     bool undo() override;
 
-    int getSizeInUnits() override { return (int) sizeof(*this); }
+    int getSizeInUnits() override {
+        int size = (int) sizeof(*this);
+        for (auto *deleteProcessorAction : deleteProcessorActions)
+            size += deleteProcessorAction->getSizeInUnits();
+        return size;
+    }
 
 private:
     ValueTree deletedTrackState;
@@ -4,13 +4,19 @@
 #include "UpdateAllDefaultConnections.h"
 
 struct MoveSelectedItems : UndoableAction {
-    MoveSelectedItems(juce::Point<int> fromTrackAndSlot, juce::Point<int> toTrackAndSlot, bool makeInvalidDefaultsIntoCustom,
+    // `trackAndSlotDelta` is expected to already be limited (see `SlotPositions::limitMoveDelta`).
+    MoveSelectedItems(juce::Point<int> trackAndSlotDelta, bool makeInvalidDefaultsIntoCustom,
                       Tracks &, Connections &, View &, Input &, Output &, AllProcessors &, ProcessorGraph &);
 
     bool perform() override;
     bool undo() override;
 
-    int getSizeInUnits() override { return (int) sizeof(*this); }
+    int getSizeInUnits() override {
+        int size = (int) sizeof(*this) + updateSelectionAction.getSizeInUnits() + updateConnectionsAction.getSizeInUnits();
+        for (auto *insertAction : insertTrackOrProcessorActions)
+            size += insertAction->getSizeInUnits();
+        return size;
+    }
 
 private:
     struct MoveSelectionsAction : public Select {
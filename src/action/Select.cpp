@@ -14,12 +14,27 @@ Select::Select(Tracks &tracks, Connections &connections, View &view, Input &inpu
 Select::Select(Select *coalesceLeft, Select *coalesceRight, Tracks &tracks, Connections &connections, View &view, Input &input, AllProcessors &allProcessors, ProcessorGraph &processorGraph)
         : tracks(tracks), connections(connections), view(view),
           input(input), allProcessors(allProcessors), processorGraph(processorGraph),
-          oldSelectedSlotsMasks(std::move(coalesceLeft->oldSelectedSlotsMasks)), newSelectedSlotsMasks(std::move(coalesceRight->newSelectedSlotsMasks)),
-          oldTrackSelections(std::move(coalesceLeft->oldTrackSelections)), newTrackSelections(std::move(coalesceRight->newTrackSelections)),
           oldFocusedSlot(coalesceLeft->oldFocusedSlot), newFocusedSlot(coalesceRight->newFocusedSlot) {
-    jassert(this->oldTrackSelections.size() == this->newTrackSelections.size());
-    jassert(this->newTrackSelections.size() == this->newSelectedSlotsMasks.size());
-    jassert(this->newSelectedSlotsMasks.size() == this->tracks.size());
+    coalesceLeft->compact();
+    coalesceRight->compact();
+    jassert(coalesceLeft->numTracks == coalesceRight->numTracks);
+
+    numTracks = coalesceRight->numTracks;
+    compacted = true;
+    trackSelectionChanges = std::move(coalesceLeft->trackSelectionChanges);
+    for (const auto &rightChange : coalesceRight->trackSelectionChanges) {
+        bool merged = false;
+        for (auto &change : trackSelectionChanges) {
+            if (change.trackIndex == rightChange.trackIndex) {
+                change.newTrackSelected = rightChange.newTrackSelected;
+                change.newSelectedSlotsMask = rightChange.newSelectedSlotsMask;
+                merged = true;
+                break;
+            }
+        }
+        if (!merged) trackSelectionChanges.add(rightChange);
+    }
+    trackSelectionChanges.removeIf([](const auto &change) { return !change.changed(); });
 
     if (coalesceLeft->resetInputsAction != nullptr) {
         this->resetInputsAction = std::move(coalesceLeft->resetInputsAction);
@@ -43,10 +58,10 @@ void Select::setNewFocusedSlot(juce::Point<int> newFocusedSlot, bool resetDefaul
 bool Select::perform() {
     if (!changed()) return false;
 
-    for (int i = 0; i < newTrackSelections.size(); i++) {
-        auto *track = tracks.get(i);
-        track->setSelected(newTrackSelections.getUnchecked(i));
-        track->getProcessorLane()->setSelectedSlotsMask(newSelectedSlotsMasks.getUnchecked(i));
+    for (const auto &change : trackSelectionChanges) {
+        auto *track = tracks.get(change.trackIndex);
+        track->setSelected(change.newTrackSelected);
+        track->getProcessorLane()->setSelectedSlotsMask(change.newSelectedSlotsMask);
     }
     if (newFocusedSlot != oldFocusedSlot)
         updateViewFocus(newFocusedSlot);
@@ -61,10 +76,11 @@ bool Select::undo() {
 
     if (resetInputsAction != nullptr)
         resetInputsAction->undo();
-    for (int i = 0; i < oldTrackSelections.size(); i++) {
-        auto *track = tracks.get(i);
-        track->setSelected(oldTrackSelections.getUnchecked(i));
-        track->getProcessorLane()->setSelectedSlotsMask(oldSelectedSlotsMasks.getUnchecked(i));
+    for (int i = trackSelectionChanges.size() - 1; i >= 0; i--) {
+        const auto &change = trackSelectionChanges.getReference(i);
+        auto *track = tracks.get(change.trackIndex);
+        track->setSelected(change.oldTrackSelected);
+        track->getProcessorLane()->setSelectedSlotsMask(change.oldSelectedSlotsMask);
     }
     if (oldFocusedSlot != newFocusedSlot)
         updateViewFocus(oldFocusedSlot);
@@ -79,8 +95,9 @@ UndoableAction *Select::createCoalescedAction(UndoableAction *nextAction) {
 }
 
 bool Select::canCoalesceWith(Select *otherAction) {
-    return oldSelectedSlotsMasks.size() == otherAction->oldSelectedSlotsMasks.size() &&
-           oldTrackSelections.size() == otherAction->oldTrackSelections.size();
+    compact();
+    otherAction->compact();
+    return numTracks == otherAction->numTracks;
 }
 
 void Select::updateViewFocus(const juce::Point<int> focusedSlot) {
@@ -94,12 +111,23 @@ void Select::updateViewFocus(const juce::Point<int> focusedSlot) {
 }
 
 bool Select::changed() {
-    if (resetInputsAction != nullptr || oldFocusedSlot != newFocusedSlot) return true;
+    compact();
+    return resetInputsAction != nullptr || oldFocusedSlot != newFocusedSlot || !trackSelectionChanges.isEmpty();
+}
+
+void Select::compact() {
+    if (compacted) return;
 
-    for (int i = 0; i < oldSelectedSlotsMasks.size(); i++) {
-        if (oldSelectedSlotsMasks.getUnchecked(i) != newSelectedSlotsMasks.getUnchecked(i) ||
-            oldTrackSelections.getUnchecked(i) != newTrackSelections.getUnchecked(i))
-            return true;
+    numTracks = oldTrackSelections.size();
+    for (int i = 0; i < numTracks; i++) {
+        TrackSelectionChange change{i, oldTrackSelections.getUnchecked(i), newTrackSelections.getUnchecked(i),
+                                    oldSelectedSlotsMasks.getUnchecked(i), newSelectedSlotsMasks.getUnchecked(i)};
+        if (change.changed())
+            trackSelectionChanges.add(std::move(change));
     }
-    return false;
+    oldSelectedSlotsMasks.clear();
+    newSelectedSlotsMasks.clear();
+    oldTrackSelections.clear();
+    newTrackSelections.clear();
+    compacted = true;
 }
@@ -14,7 +14,7 @@ struct Select : public UndoableAction {
     bool perform() override;
     bool undo() override;
 
-    int getSizeInUnits() override { return (int) sizeof(*this); }
+    int getSizeInUnits() override { return (int) (sizeof(*this) + size_t(trackSelectionChanges.size()) * sizeof(TrackSelectionChange)); }
 
     UndoableAction *createCoalescedAction(UndoableAction *nextAction) override;
 
@@ -30,9 +30,26 @@ protected:
     AllProcessors &allProcessors;
     ProcessorGraph &processorGraph;
 
+    // Full per-track selections, for subclasses to fill in on construction.
+    // These are compacted down to only the tracks that actually change the first time the action is performed.
     Array<BigInteger> oldSelectedSlotsMasks, newSelectedSlotsMasks;
     Array<bool> oldTrackSelections, newTrackSelections;
     juce::Point<int> oldFocusedSlot, newFocusedSlot;
 
     std::unique_ptr<ResetDefaultExternalInputConnectionsAction> resetInputsAction;
+
+private:
+    struct TrackSelectionChange {
+        int trackIndex;
+        bool oldTrackSelected, newTrackSelected;
+        BigInteger oldSelectedSlotsMask, newSelectedSlotsMask;
+
+        bool changed() const { return oldTrackSelected != newTrackSelected || oldSelectedSlotsMask != newSelectedSlotsMask; }
+    };
+
+    Array<TrackSelectionChange> trackSelectionChanges;
+    int numTracks{0};
+    bool compacted{false};
+
+    void compact();
 };
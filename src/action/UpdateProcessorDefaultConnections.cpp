@@ -16,11 +16,8 @@ UpdateProcessorDefaultConnections::UpdateProcessorDefaultConnections(const Proce
         coalesceWith(disconnectDefaultsAction);
         if (makeInvalidDefaultsIntoCustom) {
             if (!disconnectDefaultsAction.connectionsToDelete.isEmpty()) {
-                for (const auto *connectionToConvert : disconnectDefaultsAction.connectionsToDelete) {
-                    auto customConnection = std::make_unique<Connection>(connectionToConvert);
-                    customConnection->setCustom(true);
-                    connectionsToCreate.add(std::move(customConnection));
-                }
+                for (const auto &connectionToConvert : disconnectDefaultsAction.connectionsToDelete)
+                    connectionsToCreate.add({connectionToConvert.connection, true});
             }
         } else {
             coalesceWith(DefaultConnectProcessor(processor, nodeIdToConnectTo, connectionType, connections, allProcessors, processorGraph));
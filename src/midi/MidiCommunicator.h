@@ -9,6 +9,7 @@ public:
     explicit MidiCommunicator() = default;
 
     void setMidiInputAndOutput(std::unique_ptr<MidiInput> midiInput, std::unique_ptr<MidiOutput> midiOutput) {
+        virtualDeviceOutput = nullptr;
         this->midiInput = std::move(midiInput);
         this->midiOutput = std::move(midiOutput);
         if (this->midiInput != nullptr && this->midiOutput != nullptr) {
@@ -19,6 +20,17 @@ public:
         }
     }
 
+    // Talk to a device that isn't behind MIDI ports, like a software stand-in for one.
+    // Messages for the device go to `deviceOutput`, and its messages come in through `handleIncomingMidiMessage`.
+    void setVirtualDevice(std::function<void(const MidiMessage &)> deviceOutput) {
+        midiInput = nullptr;
+        midiOutput = nullptr;
+        virtualDeviceOutput = std::move(deviceOutput);
+        initialized = virtualDeviceOutput != nullptr;
+        if (initialized)
+            initialize();
+    }
+
     bool isInitialized() const { return initialized; }
 
     void addMidiInputCallback(MidiInputCallback *callbackToAdd) {
@@ -31,7 +43,7 @@ public:
         midiCallbacks.removeAllInstancesOf(callbackToRemove);
     }
 
-    bool isOutputConnected() const { return midiOutput != nullptr; }
+    bool isOutputConnected() const { return midiOutput != nullptr || virtualDeviceOutput != nullptr; }
 
     void handleIncomingMidiMessage(MidiInput *source, const MidiMessage &message) override {
         if (!message.isActiveSense()) {
@@ -49,8 +61,27 @@ protected:
     Array<MidiInputCallback *> midiCallbacks;
     CriticalSection midiCallbackLock;
 
-    virtual void initialize() { midiInput->start(); }
+    virtual void initialize() {
+        if (midiInput != nullptr)
+            midiInput->start();
+    }
+
+    void sendMessageNow(const MidiMessage &message) const {
+        if (midiOutput != nullptr)
+            midiOutput->sendMessageNow(message);
+        else if (virtualDeviceOutput != nullptr)
+            virtualDeviceOutput(message);
+    }
+
+    void sendBlockOfMessagesNow(const MidiBuffer &messages) const {
+        if (midiOutput != nullptr)
+            midiOutput->sendBlockOfMessagesNow(messages);
+        else if (virtualDeviceOutput != nullptr)
+            for (const auto metadata : messages)
+                virtualDeviceOutput(metadata.getMessage());
+    }
 
 private:
     bool initialized{false};
+    std::function<void(const MidiMessage &)> virtualDeviceOutput;
 };
@@ -33,9 +33,9 @@ struct Connections : public Stateful<Connections>, StatefulList<fg::Connection>
         return nullptr;
     }
 
-    void append(const fg::Connection *connection) {
-        fg::Connection copy(connection);
-        state.appendChild(copy.getState(), nullptr);
+    void append(const AudioProcessorGraph::Connection &audioConnection, bool isDefault) {
+        fg::Connection connection(audioConnection, isDefault);
+        state.appendChild(connection.getState(), nullptr);
     }
     void removeAudioConnection(const AudioProcessorGraph::Connection audioConnection) {
         if (auto *connection = getConnectionMatching(audioConnection)) {
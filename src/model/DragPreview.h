@@ -0,0 +1,46 @@
+#pragma once
+
+#include "SlotPositions.h"
+
+// Where the items being dragged would land if they were dropped now.
+// Only lives in memory while dragging, so it never shows up in the (saved and journaled) project state.
+// Listeners get a (coalesced, async) change message whenever the previewed move changes.
+struct DragPreview : public ChangeBroadcaster {
+    bool isActive() const { return active; }
+    // The (limited) move that dropping would make.
+    juce::Point<int> getMoveDelta() const { return moveDelta; }
+    // Whether a selected processor would end up in the given track/slot.
+    bool isMoveTarget(juce::Point<int> trackAndSlot) const { return active && slotPositions.isMoveTarget(moveDelta, trackAndSlot); }
+
+    // `slotPositionsAtStart` is a snapshot as of the start of the drag.
+    void begin(SlotPositions slotPositionsAtStart) {
+        slotPositions = std::move(slotPositionsAtStart);
+        active = true;
+        moveDelta = {0, 0};
+        sendChangeMessage();
+    }
+
+    // Preview moving the selection from one grid position to another.
+    void moveTo(juce::Point<int> fromTrackAndSlot, juce::Point<int> toTrackAndSlot) {
+        // Many grid positions limit down to the same move.
+        const auto newMoveDelta = slotPositions.limitMoveDelta(fromTrackAndSlot, toTrackAndSlot);
+        if (newMoveDelta == moveDelta) return;
+
+        moveDelta = newMoveDelta;
+        sendChangeMessage();
+    }
+
+    void end() {
+        if (!active) return;
+
+        active = false;
+        moveDelta = {0, 0};
+        slotPositions = {};
+        sendChangeMessage();
+    }
+
+private:
+    bool active{false};
+    juce::Point<int> moveDelta{0, 0};
+    SlotPositions slotPositions;
+};
@@ -10,6 +10,7 @@
 #include "Connection.h"
 #include "processors/InternalPluginFormat.h"
 #include "ConnectionType.h"
+#include "ProcessorStateBlob.h"
 #include "view/PluginWindowType.h"
 
 namespace ProcessorIDs {
@@ -25,6 +26,7 @@ ID(acceptsMidi)
 ID(producesMidi)
 ID(deviceName)
 ID(state)
+ID(stateBlob)
 ID(allowDefaultConnections)
 ID(pluginWindowType)
 ID(pluginWindowX)
@@ -32,6 +34,11 @@ ID(pluginWindowY)
 #undef ID
 }
 
+// For (constant-time) `std::unordered_map`s keyed by node ID.
+struct NodeIDHash {
+    size_t operator()(juce::AudioProcessorGraph::NodeID nodeId) const { return std::hash<juce::uint32>()(nodeId.uid); }
+};
+
 // TODO override loadFromState
 struct Processor : public Stateful<Processor>, public AudioProcessorListener {
     Processor(UndoManager &undoManager, AudioDeviceManager &deviceManager): Stateful<Processor>(), undoManager(undoManager), deviceManager(deviceManager) {}
@@ -60,6 +67,7 @@ struct Processor : public Stateful<Processor>, public AudioProcessorListener {
     bool hasNodeId() const { return state.hasProperty(ProcessorIDs::nodeId); }
     String getProcessorState() const { return state[ProcessorIDs::state]; }
     bool hasProcessorState() const { return state.hasProperty(ProcessorIDs::state); }
+    ProcessorStateBlob *getProcessorStateBlob() const { return dynamic_cast<ProcessorStateBlob *>(state[ProcessorIDs::stateBlob].getObject()); }
     bool isInitialized() const { return state[ProcessorIDs::initialized]; }
     bool isBypassed() const { return state[ProcessorIDs::bypassed]; }
     bool acceptsMidi() const { return state[ProcessorIDs::acceptsMidi]; }
@@ -94,7 +102,8 @@ struct Processor : public Stateful<Processor>, public AudioProcessorListener {
     void setName(const String &name) { state.setProperty(ProcessorIDs::name, name, nullptr); }
     void setDeviceName(const String &deviceName) { state.setProperty(ProcessorIDs::deviceName, deviceName, nullptr); }
     void setSlot(int slot) { state.setProperty(ProcessorIDs::slot, slot, nullptr); }
-    void setProcessorState(const String &processorState) { state.setProperty(ProcessorIDs::state, processorState, nullptr); }
+    void setProcessorState(const String &processorState) { setProcessorState(state, processorState); }
+    void setProcessorStateBlob(ProcessorStateBlob::Ptr stateBlob) { setProcessorStateBlob(state, std::move(stateBlob)); }
     void setInitialized(bool initialized) { state.setProperty(ProcessorIDs::initialized, initialized, nullptr); }
     void setBypassed(bool bypassed, UndoManager *undoManager = nullptr) { state.setProperty(ProcessorIDs::bypassed, bypassed, undoManager); }
     void setAcceptsMidi(bool acceptsMidi) { state.setProperty(ProcessorIDs::acceptsMidi, acceptsMidi, nullptr); }
@@ -112,7 +121,14 @@ struct Processor : public Stateful<Processor>, public AudioProcessorListener {
     static AudioProcessorGraph::NodeID getNodeId(const ValueTree &state) { return state.isValid() ? AudioProcessorGraph::NodeID(static_cast<uint32>(int(state[ProcessorIDs::nodeId]))) : AudioProcessorGraph::NodeID{}; }
 
     static void setId(ValueTree &state, const String &id) { state.setProperty(ProcessorIDs::id, id, nullptr); }
-    static void setProcessorState(ValueTree &state, const String &processorState) { state.setProperty(ProcessorIDs::state, processorState, nullptr); }
+    static void setProcessorState(ValueTree &state, const String &processorState) {
+        state.setProperty(ProcessorIDs::state, processorState, nullptr);
+        state.removeProperty(ProcessorIDs::stateBlob, nullptr);
+    }
+    static void setProcessorStateBlob(ValueTree &state, ProcessorStateBlob::Ptr stateBlob) {
+        state.setProperty(ProcessorIDs::stateBlob, stateBlob.get(), nullptr);
+        state.removeProperty(ProcessorIDs::state, nullptr);
+    }
     static void setName(ValueTree &state, const String &name) { state.setProperty(ProcessorIDs::name, name, nullptr); }
     static void setDeviceName(ValueTree &state, const String &deviceName) { state.setProperty(ProcessorIDs::deviceName, deviceName, nullptr); }
 
@@ -14,3 +14,84 @@ void ProcessorLane::loadFromState(const ValueTree &fromState) {
         resetVarToBool(processor, ProcessorIDs::allowDefaultConnections, nullptr);
     }
 }
+
+void ProcessorLane::onChildAdded(Processor *processor) {
+    indexSlot(processor);
+    indexNodeId(processor);
+}
+
+void ProcessorLane::onChildChanged(Processor *processor, const Identifier &i) {
+    if (processor == nullptr) return;
+
+    if (i == ProcessorIDs::slot) {
+        unindexSlot(processor);
+        indexSlot(processor);
+    } else if (i == ProcessorIDs::nodeId) {
+        unindexNodeId(processor);
+        indexNodeId(processor);
+    }
+}
+
+void ProcessorLane::onOrderChanged() {
+    // Only matters for resolving which processor wins a shared slot.
+    rebuildIndexes();
+}
+
+void ProcessorLane::valueTreeChildRemoved(ValueTree &exParent, ValueTree &tree, int oldIndex) {
+    // Unindex before notifying listeners, so lookups made from removal callbacks don't find the removed processor.
+    if (exParent == parent && isChildType(tree)) {
+        if (auto *processor = getChildForState(tree)) {
+            unindexSlot(processor);
+            unindexNodeId(processor);
+        }
+    }
+    StatefulList<Processor>::valueTreeChildRemoved(exParent, tree, oldIndex);
+}
+
+void ProcessorLane::indexSlot(Processor *processor) {
+    int slot = processor->getSlot();
+    if (slot < 0) return;
+
+    if (slot >= processorForSlot.size())
+        processorForSlot.resize(slot + 1);
+    auto *existingProcessor = processorForSlot.getUnchecked(slot);
+    if (existingProcessor == nullptr || existingProcessor == processor || indexOf(processor) < indexOf(existingProcessor))
+        processorForSlot.setUnchecked(slot, processor);
+}
+
+void ProcessorLane::unindexSlot(Processor *processor) {
+    int slot = processorForSlot.indexOf(processor);
+    if (slot == -1) return;
+
+    processorForSlot.setUnchecked(slot, nullptr);
+    // Hand the slot over to any other processor sharing it.
+    for (auto *otherProcessor : children) {
+        if (otherProcessor != processor && otherProcessor->getSlot() == slot) {
+            processorForSlot.setUnchecked(slot, otherProcessor);
+            break;
+        }
+    }
+}
+
+void ProcessorLane::indexNodeId(Processor *processor) {
+    if (processor->hasNodeId())
+        processorForNodeId.emplace(processor->getNodeId(), processor);
+}
+
+void ProcessorLane::unindexNodeId(Processor *processor) {
+    for (auto it = processorForNodeId.begin(); it != processorForNodeId.end(); ++it) {
+        if (it->second == processor) {
+            processorForNodeId.erase(it);
+            break;
+        }
+    }
+}
+
+void ProcessorLane::rebuildIndexes() {
+    processorForSlot.clearQuick();
+    processorForNodeId.clear();
+    for (auto *processor : children) {
+        indexSlot(processor);
+        indexNodeId(processor);
+    }
+}
@@ -32,17 +32,10 @@ struct ProcessorLane : public Stateful<ProcessorLane>, public StatefulList<Proce
 
     int getIndex() const { return state.getParent().indexOf(state); }
 
-    Processor *getProcessorAtSlot(int slot) const {
-        for (auto *processor : children)
-            if (processor->getSlot() == slot)
-                return processor;
-        return nullptr;
-    }
+    Processor *getProcessorAtSlot(int slot) const { return processorForSlot[slot]; }
     Processor *getProcessorByNodeId(juce::AudioProcessorGraph::NodeID nodeId) const {
-        for (auto *processor : children)
-            if (processor->getNodeId() == nodeId)
-                return processor;
-        return nullptr;
+        auto nodeIdAndProcessor = processorForNodeId.find(nodeId);
+        return nodeIdAndProcessor != processorForNodeId.end() ? nodeIdAndProcessor->second : nullptr;
     }
 
     BigInteger getSelectedSlotsMask() const {
@@ -58,7 +51,24 @@ struct ProcessorLane : public Stateful<ProcessorLane>, public StatefulList<Proce
 protected:
     Processor *createNewObject(const ValueTree &tree) override { return new Processor(tree, undoManager, deviceManager); }
 
+    void onChildAdded(Processor *processor) override;
+    void onChildChanged(Processor *processor, const Identifier &i) override;
+    void onOrderChanged() override;
+    void valueTreeChildRemoved(ValueTree &exParent, ValueTree &tree, int oldIndex) override;
+
 private:
     UndoManager &undoManager;
     AudioDeviceManager &deviceManager;
+
+    // Lookup indexes, kept in sync with the processor states.
+    // Slots are bounded by the view's processor slot count, so a flat slot-indexed array is enough.
+    // If processors transiently share a slot (mid-move), the slot maps to the first one in lane order.
+    Array<Processor *> processorForSlot;
+    std::unordered_map<juce::AudioProcessorGraph::NodeID, Processor *, NodeIDHash> processorForNodeId;
+
+    void indexSlot(Processor *processor);
+    void unindexSlot(Processor *processor);
+    void indexNodeId(Processor *processor);
+    void unindexNodeId(Processor *processor);
+    void rebuildIndexes();
 };
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+// Immutable plugin state bytes, referenced from a processor's `stateBlob` property.
+// Lets loaded plugin state stay in the (memory-mapped) project file until a plugin instance actually needs it.
+struct ProcessorStateBlob : public juce::ReferenceCountedObject {
+    using Ptr = juce::ReferenceCountedObjectPtr<ProcessorStateBlob>;
+
+    // The data is only read through one of these, which keeps it where it is (e.g. in the mapped file) while it's alive.
+    struct ScopedRead {
+        explicit ScopedRead(const ProcessorStateBlob &blob) : blob(blob) { blob.beginRead(); }
+        ~ScopedRead() { blob.endRead(); }
+
+        const void *getData() const { return blob.getData(); }
+        size_t getSize() const { return blob.getSize(); }
+
+    private:
+        const ProcessorStateBlob &blob;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedRead)
+    };
+
+    virtual size_t getSize() const = 0;
+
+protected:
+    virtual const void *getData() const = 0;
+    virtual void beginRead() const {}
+    virtual void endRead() const {}
+};
+
+// Plugin state captured into memory, e.g. for a background snapshot of the project.
+struct MemoryProcessorStateBlob : public ProcessorStateBlob {
+    explicit MemoryProcessorStateBlob(juce::MemoryBlock data) : data(std::move(data)) {}
+
+    size_t getSize() const override { return data.getSize(); }
+
+protected:
+    const void *getData() const override { return data.getData(); }
+
+private:
+    const juce::MemoryBlock data;
+};
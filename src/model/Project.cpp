@@ -11,6 +11,7 @@
 #include "action/SelectRectangle.h"
 #include "action/Insert.h"
 #include "action/SelectTrack.h"
+#include "model/ProjectFile.h"
 #include "processors/TrackInputProcessor.h"
 #include "processors/TrackOutputProcessor.h"
 #include "processors/SineBank.h"
@@ -28,7 +29,8 @@ Project::Project(View &view, Tracks &tracks, Connections &connections, Input &in
           processorGraph(processorGraph),
           undoManager(undoManager),
           pluginManager(pluginManager),
-          deviceManager(deviceManager) {
+          deviceManager(deviceManager),
+          journal(state, undoManager, processorGraph.getProcessorWrappers()) {
     state.setProperty(ProjectIDs::name, "My Project", nullptr);
     state.appendChild(input.getState(), nullptr);
     state.appendChild(output.getState(), nullptr);
@@ -43,6 +45,8 @@ Project::~Project() {
 }
 
 void Project::loadFromState(const ValueTree &fromState) {
+    ScopedNotificationBatch notificationBatch;
+    journal.suspend();
     clear();
 
     view.loadFromParentState(fromState);
@@ -68,13 +72,25 @@ void Project::loadFromState(const ValueTree &fromState) {
         AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, TRANS("Failed to open output device \"") + outputDeviceName + "\"", failureMessage);
 
     tracks.loadFromParentState(fromState);
+
+    // Instantiate all plugins in the background. Each one joins the graph (with its connections) once it's created.
+    Array<Processor *> processorsToInstantiate;
+    processorsToInstantiate.addArray(input.getChildren());
+    processorsToInstantiate.addArray(output.getChildren());
+    for (const auto *track : tracks.getChildren())
+        processorsToInstantiate.addArray(track->getAllProcessors());
+    processorsToInstantiate.removeAllInstancesOf(nullptr);
+    processorGraph.addProcessors(processorsToInstantiate);
+
     connections.loadFromParentState(fromState);
     selectProcessor(tracks.getFocusedProcessor());
     undoManager.clearUndoHistory();
+    journal.startNewSession();
     sendChangeMessage();
 }
 
 void Project::clear() {
+    cancelDraggingProcessor();
     input.clear();
     output.clear();
     tracks.clear();
@@ -106,9 +122,9 @@ void Project::createProcessor(const PluginDescription &description, int slot) {
 }
 
 void Project::deleteSelectedItems() {
-    if (isCurrentlyDraggingProcessor())
-        endDraggingProcessor();
+    cancelDraggingProcessor();
 
+    ScopedNotificationBatch notificationBatch;
     undoManager.beginNewTransaction();
     undoManager.perform(new DeleteSelectedItems(tracks, connections, processorGraph));
     if (view.getFocusedTrackIndex() >= tracks.size() && tracks.size() > 0)
@@ -117,16 +133,16 @@ void Project::deleteSelectedItems() {
 }
 
 void Project::insert() {
-    if (isCurrentlyDraggingProcessor())
-        endDraggingProcessor();
+    cancelDraggingProcessor();
+    ScopedNotificationBatch notificationBatch;
     undoManager.beginNewTransaction();
     undoManager.perform(new Insert(false, copiedTracks, view.getFocusedTrackAndSlot(), tracks, connections, view, input, allProcessors, processorGraph));
     updateAllDefaultConnections();
 }
 
 void Project::duplicateSelectedItems() {
-    if (isCurrentlyDraggingProcessor())
-        endDraggingProcessor();
+    cancelDraggingProcessor();
+    ScopedNotificationBatch notificationBatch;
     OwnedArray<Track> duplicateTracks;
     tracks.copySelectedItemsInto(duplicateTracks, processorGraph.getProcessorWrappers());
     undoManager.beginNewTransaction();
@@ -142,9 +158,7 @@ void Project::beginDragging(const juce::Point<int> trackAndSlot) {
 
     initialDraggingTrackAndSlot = trackAndSlot;
     currentlyDraggingTrackAndSlot = initialDraggingTrackAndSlot;
-
-    // During drag actions, everything _except the audio graph_ is updated as a preview
-    processorGraph.pauseAudioGraphUpdates();
+    dragPreview.begin(SlotPositions(tracks, view));
 }
 
 void Project::dragToPosition(juce::Point<int> trackAndSlot) {
@@ -155,29 +169,29 @@ void Project::dragToPosition(juce::Point<int> trackAndSlot) {
         trackAndSlot == Tracks::INVALID_TRACK_AND_SLOT)
         return;
 
-    if (currentlyDraggingTrackAndSlot == initialDraggingTrackAndSlot)
-        undoManager.beginNewTransaction();
-
-    auto onlyMoveActionInCurrentTransaction = [&]() -> bool {
-        Array<const UndoableAction *> actionsFound;
-        undoManager.getActionsInCurrentTransaction(actionsFound);
-        return actionsFound.size() == 1 && dynamic_cast<const MoveSelectedItems *>(actionsFound.getUnchecked(0)) != nullptr;
-    };
-
-    if (undoManager.getNumActionsInCurrentTransaction() > 0) {
-        if (onlyMoveActionInCurrentTransaction()) {
-            undoManager.undoCurrentTransactionOnly();
-        } else {
-            undoManager.beginNewTransaction();
-            initialDraggingTrackAndSlot = currentlyDraggingTrackAndSlot;
-        }
-    }
+    // Only the preview follows the drag. The project itself is changed once, on the drop.
+    currentlyDraggingTrackAndSlot = trackAndSlot;
+    dragPreview.moveTo(initialDraggingTrackAndSlot, trackAndSlot);
+}
 
-    if (trackAndSlot == initialDraggingTrackAndSlot ||
-        undoManager.perform(new MoveSelectedItems(initialDraggingTrackAndSlot, trackAndSlot, isAltHeld(),
-                                                  tracks, connections, view, input, output, allProcessors, processorGraph))) {
-        currentlyDraggingTrackAndSlot = trackAndSlot;
-    }
+void Project::endDraggingProcessor() {
+    if (!isCurrentlyDraggingProcessor()) return;
+
+    // Limited against the current state, in case anything else changed it during the drag.
+    const auto dragDelta = SlotPositions(tracks, view).limitMoveDelta(initialDraggingTrackAndSlot, currentlyDraggingTrackAndSlot);
+    cancelDraggingProcessor();
+    if (dragDelta == juce::Point<int>(0, 0)) return;
+
+    processorGraph.pauseAudioGraphUpdates();
+    undoManager.beginNewTransaction();
+    undoManager.perform(new MoveSelectedItems(dragDelta, isAltHeld(), tracks, connections, view, input, output, allProcessors, processorGraph));
+    processorGraph.resumeAudioGraphUpdatesAndApplyDiffSincePause();
+}
+
+void Project::cancelDraggingProcessor() {
+    initialDraggingTrackAndSlot = Tracks::INVALID_TRACK_AND_SLOT;
+    currentlyDraggingTrackAndSlot = Tracks::INVALID_TRACK_AND_SLOT;
+    dragPreview.end();
 }
 
 void Project::setProcessorSlotSelected(Track *track, int slot, bool selected, bool deselectOthers) {
@@ -275,15 +289,23 @@ void Project::updateAllDefaultConnections() {
 }
 
 Result Project::loadDocument(const File &file) {
-    if (auto xml = std::unique_ptr<XmlElement>(XmlDocument::parse(file))) {
-        const ValueTree &newState = ValueTree::fromXml(*xml);
-        if (!newState.isValid() || !newState.hasType(ProjectIDs::PROJECT))
-            return Result::fail(TRANS("Not a valid project file"));
-
-        loadFromState(newState);
-        return Result::ok();
+    ValueTree newState;
+    if (ProjectFile::isProjectFile(file)) {
+        const auto result = ProjectFile::read(file, newState);
+        if (result.failed())
+            return result;
+    } else if (auto xml = std::unique_ptr<XmlElement>(XmlDocument::parse(file))) {
+        // Projects saved before the binary format
+        newState = ValueTree::fromXml(*xml);
+    } else {
+        return Result::fail(TRANS("Not a valid project file"));
     }
-    return Result::fail(TRANS("Not a valid XML file"));
+
+    if (!newState.isValid() || !newState.hasType(ProjectIDs::PROJECT))
+        return Result::fail(TRANS("Not a valid project file"));
+
+    loadFromState(newState);
+    return Result::ok();
 }
 
 bool Project::isDeviceWithNamePresent(const String &deviceName) const {
@@ -303,15 +325,8 @@ bool Project::isDeviceWithNamePresent(const String &deviceName) const {
 }
 
 Result Project::saveDocument(const File &file) {
-    for (const auto *track : tracks.getChildren())
-        for (auto processorState : track->getProcessorLane()->getState())
-            processorGraph.getProcessorWrappers().saveProcessorStateInformationToState(processorState);
-
-    if (auto xml = state.createXml())
-        if (!xml->writeTo(file))
-            return Result::fail(TRANS("Could not save the project file"));
-
-    return Result::ok();
+    processorGraph.getProcessorWrappers().captureAllStateInformation();
+    return ProjectFile::write(file, state, processorGraph.getProcessorWrappers(), getUserSettings()->getBoolValue("compressProjectFiles", true));
 }
 
 File Project::getLastDocumentOpened() {
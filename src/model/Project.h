@@ -7,6 +7,8 @@
 #include "model/View.h"
 #include "model/Input.h"
 #include "model/Output.h"
+#include "model/DragPreview.h"
+#include "model/ProjectJournal.h"
 #include "PluginManager.h"
 #include "ProcessorGraph.h"
 
@@ -34,18 +36,27 @@ struct Project : public Stateful<Project>, public FileBasedDocument, private Cha
 
     // TODO any way to do all this in the constructor?
     void initialize() {
-        const auto &lastOpenedProjectFile = getLastDocumentOpened();
-        if (!(lastOpenedProjectFile.exists() && loadFrom(lastOpenedProjectFile, true)))
-            newDocument();
+        ValueTree recoveredState;
+        if (journal.recover(recoveredState) && recoveredState.hasType(ProjectIDs::PROJECT)) {
+            loadFromState(recoveredState);
+            AlertWindow::showMessageBoxAsync(AlertWindow::InfoIcon, TRANS("Recovered unsaved session"),
+                                             TRANS("FlowGrid didn't shut down cleanly last time. The session has been restored from its autosave."));
+        } else {
+            const auto &lastOpenedProjectFile = getLastDocumentOpened();
+            if (!(lastOpenedProjectFile.exists() && loadFrom(lastOpenedProjectFile, true)))
+                newDocument();
+        }
         undoManager.clearUndoHistory();
     }
 
     void undo() {
-        if (isCurrentlyDraggingProcessor()) endDraggingProcessor();
+        cancelDraggingProcessor();
+        ScopedNotificationBatch notificationBatch;
         undoManager.undo();
     }
     void redo() {
-        if (isCurrentlyDraggingProcessor()) endDraggingProcessor();
+        cancelDraggingProcessor();
+        ScopedNotificationBatch notificationBatch;
         undoManager.redo();
     }
 
@@ -79,14 +90,13 @@ struct Project : public Stateful<Project>, public FileBasedDocument, private Cha
     void beginDragging(juce::Point<int> trackAndSlot);
     void dragToPosition(juce::Point<int> trackAndSlot);
 
-    void endDraggingProcessor() {
-        if (!isCurrentlyDraggingProcessor()) return;
+    // Drops the dragged items where they're currently previewed. Only for the end of the drag gesture itself.
+    void endDraggingProcessor();
+    // Stops dragging without moving anything, e.g. when something else changes the project mid-drag.
+    void cancelDraggingProcessor();
 
-        initialDraggingTrackAndSlot = Tracks::INVALID_TRACK_AND_SLOT;
-        processorGraph.resumeAudioGraphUpdatesAndApplyDiffSincePause();
-    }
-
-    bool isCurrentlyDraggingProcessor() { return initialDraggingTrackAndSlot != Tracks::INVALID_TRACK_AND_SLOT; }
+    bool isCurrentlyDraggingProcessor() const { return initialDraggingTrackAndSlot != Tracks::INVALID_TRACK_AND_SLOT; }
+    DragPreview &getDragPreview() { return dragPreview; }
 
     void setProcessorSlotSelected(Track *track, int slot, bool selected, bool deselectOthers = true);
     void setTrackSelected(Track *track, bool selected, bool deselectOthers = true);
@@ -110,9 +120,11 @@ struct Project : public Stateful<Project>, public FileBasedDocument, private Cha
 
     //==============================================================================================================
     void newDocument() {
+        journal.suspend();
         clear();
         setFile({});
         createDefaultProject();
+        journal.startNewSession();
     }
 
     String getDocumentTitle() override {
@@ -144,9 +156,13 @@ private:
 
     juce::Point<int> initialDraggingTrackAndSlot = Tracks::INVALID_TRACK_AND_SLOT,
             currentlyDraggingTrackAndSlot = Tracks::INVALID_TRACK_AND_SLOT;
+    // The (limited) move from `initialDraggingTrackAndSlot` to `currentlyDraggingTrackAndSlot`.
+    DragPreview dragPreview;
 
     OwnedArray<Track> copiedTracks;
 
+    ProjectJournal journal;
+
     void doCreateAndAddProcessor(const PluginDescription &description, Track *track, int slot = -1);
 
     void changeListenerCallback(ChangeBroadcaster *source) override;
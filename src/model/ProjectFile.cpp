@@ -0,0 +1,220 @@
+#include "ProjectFile.h"
+
+#include "ProcessorLane.h"
+
+namespace {
+struct MappedProjectFile : public ReferenceCountedObject {
+    using Ptr = ReferenceCountedObjectPtr<MappedProjectFile>;
+
+    explicit MappedProjectFile(const File &file) : file(file), mappedFile(file, MemoryMappedFile::readOnly) {}
+
+    const File file;
+    MemoryMappedFile mappedFile;
+};
+
+struct MappedProcessorStateBlob : public ProcessorStateBlob {
+    MappedProcessorStateBlob(MappedProjectFile::Ptr projectFile, int64 offset, int64 size)
+            : projectFile(std::move(projectFile)), offset(offset), size(size) {
+        const ScopedLock scopedLock(getBlobsLock());
+        getBlobs().add(this);
+    }
+
+    ~MappedProcessorStateBlob() override {
+        const ScopedLock scopedLock(getBlobsLock());
+        getBlobs().removeFirstMatchingValue(this);
+    }
+
+    size_t getSize() const override { return (size_t) size; }
+
+    // A mapped file can't be replaced on Windows. Blobs still referring to it take a copy of their own data
+    // (waiting for any reads in progress), after which the file is no longer mapped.
+    static void releaseFile(const File &file) {
+        const ScopedWriteLock writeLock(getDataLock());
+        const ScopedLock scopedLock(getBlobsLock());
+        for (auto *blob : getBlobs()) {
+            if (blob->projectFile != nullptr && blob->projectFile->file == file) {
+                blob->ownedData = MemoryBlock(blob->getData(), (size_t) blob->size);
+                blob->projectFile = nullptr;
+            }
+        }
+    }
+
+protected:
+    const void *getData() const override {
+        return projectFile != nullptr ? addBytesToPointer(projectFile->mappedFile.getData(), offset) : ownedData.getData();
+    }
+    // Reads keep the data where it is, until they're done.
+    void beginRead() const override { getDataLock().enterRead(); }
+    void endRead() const override { getDataLock().exitRead(); }
+
+private:
+    MappedProjectFile::Ptr projectFile; // Keeps the file mapped as long as any processor still refers to its state.
+    int64 offset, size;
+    MemoryBlock ownedData; // Once the file is released
+
+    static ReadWriteLock &getDataLock() {
+        static ReadWriteLock dataLock;
+        return dataLock;
+    }
+    static CriticalSection &getBlobsLock() {
+        static CriticalSection blobsLock;
+        return blobsLock;
+    }
+    static Array<MappedProcessorStateBlob *> &getBlobs() {
+        static Array<MappedProcessorStateBlob *> blobs;
+        return blobs;
+    }
+};
+}
+
+// Prefers the (cached) live plugin state, then falls back to whatever the processor state holds
+// (a blob from a loaded project, a copy or a deleted processor, or base64 state from an older XML project).
+// As with XML projects, live state is only saved for processors in processor lanes, not for track or device IO processors.
+static ProcessorStateBlob::Ptr getProcessorStateInformation(const ValueTree &processorState, const StatefulAudioProcessorWrappers *processorWrappers) {
+    if (processorWrappers != nullptr && processorState.getParent().hasType(ProcessorLaneIDs::PROCESSOR_LANE))
+        if (auto *processorWrapper = processorWrappers->getProcessorWrapperForState(processorState))
+            return processorWrapper->getStateInformation();
+    if (auto *stateBlob = dynamic_cast<ProcessorStateBlob *>(processorState[ProcessorIDs::stateBlob].getObject()))
+        return stateBlob;
+    if (processorState.hasProperty(ProcessorIDs::state)) {
+        MemoryBlock memoryBlock;
+        memoryBlock.fromBase64Encoding(processorState[ProcessorIDs::state].toString());
+        return new MemoryProcessorStateBlob(std::move(memoryBlock));
+    }
+    return {};
+}
+
+static void moveProcessorStateIntoBlobs(ValueTree tree, const StatefulAudioProcessorWrappers *processorWrappers, ReferenceCountedArray<ProcessorStateBlob> &blobs) {
+    if (Processor::isType(tree)) {
+        const auto stateInformation = getProcessorStateInformation(tree, processorWrappers);
+        tree.removeProperty(ProcessorIDs::state, nullptr);
+        if (stateInformation != nullptr && stateInformation->getSize() > 0) {
+            tree.setProperty(ProcessorIDs::stateBlob, blobs.size(), nullptr);
+            blobs.add(stateInformation);
+        } else {
+            tree.removeProperty(ProcessorIDs::stateBlob, nullptr);
+        }
+    }
+    for (auto child : tree)
+        moveProcessorStateIntoBlobs(child, processorWrappers, blobs);
+}
+
+static void resolveProcessorStateBlobs(ValueTree tree, const ReferenceCountedArray<ProcessorStateBlob> &blobs) {
+    if (Processor::isType(tree) && tree.hasProperty(ProcessorIDs::stateBlob)) {
+        if (auto *stateBlob = blobs[int(tree[ProcessorIDs::stateBlob])].get())
+            tree.setProperty(ProcessorIDs::stateBlob, stateBlob, nullptr);
+        else
+            tree.removeProperty(ProcessorIDs::stateBlob, nullptr);
+    }
+    for (auto child : tree)
+        resolveProcessorStateBlobs(child, blobs);
+}
+
+bool ProjectFile::isProjectFile(const File &file) {
+    FileInputStream stream(file);
+    return stream.openedOk() && stream.readInt() == magic;
+}
+
+Result ProjectFile::write(const File &file, const ValueTree &projectState, const StatefulAudioProcessorWrappers &processorWrappers, bool compress) {
+    return write(file, projectState, &processorWrappers, compress);
+}
+
+Result ProjectFile::write(const File &file, const ValueTree &projectState, bool compress) {
+    return write(file, projectState, nullptr, compress);
+}
+
+Result ProjectFile::write(const File &file, const ValueTree &projectState, const StatefulAudioProcessorWrappers *processorWrappers, bool compress) {
+    auto skeleton = projectState.createCopy();
+    ReferenceCountedArray<ProcessorStateBlob> blobs;
+    moveProcessorStateIntoBlobs(skeleton, processorWrappers, blobs);
+
+    MemoryOutputStream skeletonStream;
+    if (compress) {
+        GZIPCompressorOutputStream compressedSkeletonStream(skeletonStream);
+        skeleton.writeToStream(compressedSkeletonStream);
+    } else {
+        skeleton.writeToStream(skeletonStream);
+    }
+
+    // Write beside the target and swap it in, so a currently mapped project file is never modified in place.
+    TemporaryFile temporaryFile(file);
+    {
+        FileOutputStream stream(temporaryFile.getFile());
+        if (!stream.openedOk())
+            return Result::fail(TRANS("Could not save the project file"));
+
+        int64 offset = headerSize + indexEntrySize * blobs.size();
+        stream.writeInt(magic);
+        stream.writeInt(version);
+        stream.writeInt(compress ? compressedSkeletonFlag : 0);
+        stream.writeInt(blobs.size());
+        stream.writeInt64(offset);
+        stream.writeInt64((int64) skeletonStream.getDataSize());
+        offset += (int64) skeletonStream.getDataSize();
+        for (const auto *blob : blobs) {
+            stream.writeInt64(offset);
+            stream.writeInt64((int64) blob->getSize());
+            offset += (int64) blob->getSize();
+        }
+        stream.write(skeletonStream.getData(), skeletonStream.getDataSize());
+        for (const auto *blob : blobs) {
+            const ProcessorStateBlob::ScopedRead stateRead(*blob);
+            stream.write(stateRead.getData(), stateRead.getSize());
+        }
+        stream.flush();
+        if (stream.getStatus().failed())
+            return Result::fail(TRANS("Could not save the project file"));
+    }
+
+#if JUCE_WINDOWS
+    MappedProcessorStateBlob::releaseFile(file);
+#endif
+    // Elsewhere, the old file's mapping stays valid after it's replaced.
+    if (!temporaryFile.overwriteTargetFileWithTemporary())
+        return Result::fail(TRANS("Could not save the project file"));
+
+    return Result::ok();
+}
+
+Result ProjectFile::read(const File &file, ValueTree &projectState) {
+    MappedProjectFile::Ptr projectFile = new MappedProjectFile(file);
+    const auto *data = projectFile->mappedFile.getData();
+    const auto fileSize = (int64) projectFile->mappedFile.getSize();
+    if (data == nullptr || fileSize < headerSize)
+        return Result::fail(TRANS("Could not read the project file"));
+
+    MemoryInputStream headerStream(data, (size_t) fileSize, false);
+    if (headerStream.readInt() != magic)
+        return Result::fail(TRANS("Not a valid project file"));
+    if (headerStream.readInt() > version)
+        return Result::fail(TRANS("This project was saved by a newer version"));
+
+    const int flags = headerStream.readInt();
+    const int numBlobs = headerStream.readInt();
+    const int64 skeletonOffset = headerStream.readInt64();
+    const int64 skeletonSize = headerStream.readInt64();
+    if (numBlobs < 0 || headerSize + indexEntrySize * numBlobs > fileSize ||
+        skeletonOffset < 0 || skeletonSize < 0 || skeletonOffset + skeletonSize > fileSize)
+        return Result::fail(TRANS("The project file is corrupt"));
+
+    ReferenceCountedArray<ProcessorStateBlob> blobs;
+    for (int i = 0; i < numBlobs; i++) {
+        const int64 offset = headerStream.readInt64();
+        const int64 size = headerStream.readInt64();
+        if (offset < 0 || size < 0 || offset + size > fileSize)
+            return Result::fail(TRANS("The project file is corrupt"));
+
+        blobs.add(new MappedProcessorStateBlob(projectFile, offset, size));
+    }
+
+    MemoryInputStream skeletonStream(addBytesToPointer(data, skeletonOffset), (size_t) skeletonSize, false);
+    if (flags & compressedSkeletonFlag) {
+        GZIPDecompressorInputStream decompressedSkeletonStream(skeletonStream);
+        projectState = ValueTree::readFromStream(decompressedSkeletonStream);
+    } else {
+        projectState = ValueTree::readFromStream(skeletonStream);
+    }
+
+    resolveProcessorStateBlobs(projectState, blobs);
+    return Result::ok();
+}
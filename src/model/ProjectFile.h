@@ -0,0 +1,33 @@
+#pragma once
+
+#include "StatefulAudioProcessorWrappers.h"
+
+// Binary project container:
+//   header (magic, version, flags, blob count, skeleton offset & size),
+//   blob index (offset & size per plugin state blob),
+//   skeleton (the project `ValueTree` via `writeToStream`, plugin state stripped, optionally GZIP-compressed),
+//   raw plugin state blobs.
+// Processors in the skeleton refer to their blob by index. When read back, these indices are replaced with
+// `ProcessorStateBlob`s pointing into the memory-mapped file, so plugin state is only paged in when a plugin is instantiated.
+// Saves replace the file, so an old mapping stays valid. (Except on Windows, where blobs still pointing into it take a copy
+// of their own data first, so the file can be released.)
+struct ProjectFile {
+    static bool isProjectFile(const File &file);
+
+    // Plugin state comes from the processor wrappers' state caches.
+    // Stale caches are re-captured one by one. Call `captureAllStateInformation` first to do that in parallel.
+    static Result write(const File &file, const ValueTree &projectState, const StatefulAudioProcessorWrappers &processorWrappers, bool compress);
+    // Write plugin state as held by the processor states themselves, without asking any live plugin instances.
+    // Safe to call off the message thread with a tree no one else is using.
+    static Result write(const File &file, const ValueTree &projectState, bool compress);
+    static Result read(const File &file, ValueTree &projectState);
+
+private:
+    static Result write(const File &file, const ValueTree &projectState, const StatefulAudioProcessorWrappers *processorWrappers, bool compress);
+
+    static constexpr int magic = 0x4a504746; // "FGPJ"
+    static constexpr int version = 1;
+    static constexpr int compressedSkeletonFlag = 1;
+    static constexpr int64 headerSize = 4 * sizeof(int) + 2 * sizeof(int64);
+    static constexpr int64 indexEntrySize = 2 * sizeof(int64);
+};
@@ -0,0 +1,329 @@
+#include "ProjectJournal.h"
+
+#include "ProjectFile.h"
+#include "ApplicationPropertiesAndCommandManager.h"
+
+namespace {
+enum RecordType : char { propertyChanged, propertyRemoved, childAdded, childRemoved, childMoved, processorStateChanged };
+
+const Identifier sessionIdProperty("autosaveSessionId");
+}
+
+static bool containsProcessorStateBlob(const ValueTree &tree) {
+    if (Processor::isType(tree) && tree[ProcessorIDs::stateBlob].isObject()) return true;
+    for (const auto &child : tree)
+        if (containsProcessorStateBlob(child))
+            return true;
+    return false;
+}
+
+// State blobs are objects, which can't be written to a stream. They're journaled as separate (raw) records.
+static void removeProcessorStateBlobs(ValueTree tree) {
+    if (Processor::isType(tree))
+        tree.removeProperty(ProcessorIDs::stateBlob, nullptr);
+    for (auto child : tree)
+        removeProcessorStateBlobs(child);
+}
+
+// Processors whose state was never captured keep whatever state they were loaded with.
+static void setCachedProcessorState(ValueTree tree, const StatefulAudioProcessorWrappers &processorWrappers,
+                                    std::unordered_map<juce::AudioProcessorGraph::NodeID, ProcessorStateBlob::Ptr, NodeIDHash> &cachedStateInformation) {
+    if (Processor::isType(tree)) {
+        if (auto *processorWrapper = processorWrappers.getProcessorWrapperForState(tree)) {
+            if (auto stateInformation = processorWrapper->getStateInformationCache()) {
+                Processor::setProcessorStateBlob(tree, stateInformation);
+                cachedStateInformation[processorWrapper->getNodeId()] = stateInformation;
+            }
+        }
+    }
+    for (auto child : tree)
+        setCachedProcessorState(child, processorWrappers, cachedStateInformation);
+}
+
+static ValueTree readPath(ValueTree root, InputStream &stream) {
+    for (int pathLength = stream.readCompressedInt(); pathLength > 0; pathLength--)
+        root = root.getChild(stream.readCompressedInt());
+    return root;
+}
+
+static bool applyRecords(ValueTree &root, InputStream &stream) {
+    while (!stream.isExhausted()) {
+        const auto type = stream.readByte();
+        auto tree = readPath(root, stream);
+        if (!tree.isValid()) return false;
+
+        switch (type) {
+            case propertyChanged: {
+                const Identifier property(stream.readString());
+                tree.setProperty(property, var::readFromStream(stream), nullptr);
+                break;
+            }
+            case propertyRemoved:
+                tree.removeProperty(Identifier(stream.readString()), nullptr);
+                break;
+            case childAdded: {
+                const int index = stream.readCompressedInt();
+                tree.addChild(ValueTree::readFromStream(stream), index, nullptr);
+                break;
+            }
+            case childRemoved:
+                tree.removeChild(stream.readCompressedInt(), nullptr);
+                break;
+            case childMoved: {
+                const int oldIndex = stream.readCompressedInt();
+                const int newIndex = stream.readCompressedInt();
+                tree.moveChild(oldIndex, newIndex, nullptr);
+                break;
+            }
+            case processorStateChanged: {
+                const int64 size = stream.readInt64();
+                if (size < 0 || size > stream.getNumBytesRemaining()) return false;
+
+                MemoryBlock stateInformation;
+                stream.readIntoMemoryBlock(stateInformation, (ssize_t) size);
+                Processor::setProcessorStateBlob(tree, new MemoryProcessorStateBlob(std::move(stateInformation)));
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+ProjectJournal::ProjectJournal(ValueTree &projectState, UndoManager &undoManager, StatefulAudioProcessorWrappers &processorWrappers)
+        : projectState(projectState), undoManager(undoManager), processorWrappers(processorWrappers) {
+    projectState.addListener(this);
+    undoManager.addChangeListener(this);
+}
+
+ProjectJournal::~ProjectJournal() {
+    stopTimer();
+    undoManager.removeChangeListener(this);
+    projectState.removeListener(this);
+    // Let everything already handed to the writer thread finish (in order), before removing it all.
+    WaitableEvent allWritten;
+    writer.addJob([&allWritten] { allWritten.signal(); });
+    allWritten.wait();
+    journalStream.reset();
+    // Clean shutdown. Nothing to recover.
+    // Unless this instance never journaled a session of its own (e.g. it quit right after recovering one),
+    // in which case the directory it holds, if any, is still the only copy of that session.
+    if (sessionStarted)
+        directory.deleteRecursively();
+}
+
+File ProjectJournal::getAutosaveDirectory() {
+    return getUserSettings()->getFile().getSiblingFile("Autosave");
+}
+
+// Held for as long as the instance owning the directory is running. Returns `nullptr` if another instance holds it.
+std::unique_ptr<InterProcessLock> ProjectJournal::lockDirectory(const File &directory) {
+    auto lock = std::make_unique<InterProcessLock>("FlowGridAutosave_" + directory.getFileName());
+    return lock->enter(0) ? std::move(lock) : nullptr;
+}
+
+void ProjectJournal::suspend() {
+    suspended = true;
+    stopTimer();
+    pendingRecords.reset();
+}
+
+void ProjectJournal::startNewSession() {
+    if (directoryLock == nullptr) {
+        directory = getAutosaveDirectory().getChildFile(Uuid().toString());
+        directoryLock = lockDirectory(directory);
+    }
+    sessionStarted = true;
+    suspended = false;
+    pendingRecords.reset();
+    writeSnapshot();
+    startTimer(flushIntervalMs);
+}
+
+bool ProjectJournal::recover(ValueTree &recoveredState) {
+    for (const auto &sessionDirectory : getAutosaveDirectory().findChildFiles(File::findDirectories, false)) {
+        // Still in use by a running instance.
+        auto sessionDirectoryLock = lockDirectory(sessionDirectory);
+        if (sessionDirectoryLock == nullptr) continue;
+
+        ValueTree snapshot;
+        if (ProjectFile::read(getSnapshotFile(sessionDirectory), snapshot).failed() || !snapshot.isValid()) {
+            // Nothing recoverable left in it.
+            sessionDirectory.deleteRecursively();
+            continue;
+        }
+
+        directory = sessionDirectory;
+        directoryLock = std::move(sessionDirectoryLock);
+        recoveredState = snapshot;
+        break;
+    }
+    if (!recoveredState.isValid()) return false;
+
+    const auto sessionId = (int64) recoveredState[sessionIdProperty];
+    recoveredState.removeProperty(sessionIdProperty, nullptr);
+
+    FileInputStream journal(getJournalFile(directory));
+    // A journal from a different session is left over from a compaction that didn't finish, and is already part of the snapshot.
+    if (journal.openedOk() && journal.readInt64() == sessionId) {
+        while (journal.getNumBytesRemaining() >= (int64) sizeof(int)) {
+            const int size = journal.readInt();
+            if (size <= 0 || journal.getNumBytesRemaining() < size) break; // Torn write of the last transaction
+
+            MemoryBlock records;
+            journal.readIntoMemoryBlock(records, size);
+            MemoryInputStream recordStream(records, false);
+            if (!applyRecords(recoveredState, recordStream)) break;
+        }
+    }
+    return true;
+}
+
+void ProjectJournal::flushPendingRecords() {
+    if (suspended) return;
+
+    // Only plugins whose state changed since their last capture are captured again, and only those hosted in this
+    // process are captured right here. The rest is journaled by a later flush, once its background capture is done.
+    processorWrappers.captureAllStateInformationInBackground();
+    if (processorWrappers.anyStateInformationCacheDiffers(journaledStateInformation))
+        journalChangedProcessorState(projectState);
+    if (pendingRecords.getDataSize() == 0) return;
+
+    writer.addJob([this, records = pendingRecords.getMemoryBlock()] {
+        if (journalStream == nullptr) return;
+
+        journalStream->writeInt((int) records.getSize());
+        journalStream->write(records.getData(), records.getSize());
+        journalStream->flush();
+        journalSize += (int64) (sizeof(int) + records.getSize());
+    });
+    pendingRecords.reset();
+
+    if (journalSize > maxJournalSize)
+        writeSnapshot();
+}
+
+void ProjectJournal::journalChangedProcessorState(const ValueTree &tree) {
+    if (Processor::isType(tree)) {
+        if (auto *processorWrapper = processorWrappers.getProcessorWrapperForState(tree)) {
+            auto stateInformation = processorWrapper->getStateInformationCache();
+            auto &journaledState = journaledStateInformation[processorWrapper->getNodeId()];
+            if (stateInformation != nullptr && stateInformation != journaledState) {
+                writeProcessorState(tree, *stateInformation);
+                journaledState = stateInformation;
+            }
+        }
+    }
+    for (const auto &child : tree)
+        journalChangedProcessorState(child);
+}
+
+void ProjectJournal::journalProcessorStateBlobs(const ValueTree &tree) {
+    if (Processor::isType(tree))
+        if (auto *stateBlob = dynamic_cast<ProcessorStateBlob *>(tree[ProcessorIDs::stateBlob].getObject()))
+            writeProcessorState(tree, *stateBlob);
+    for (const auto &child : tree)
+        journalProcessorStateBlobs(child);
+}
+
+// Raw and length-prefixed, rather than a base64 `var`.
+void ProjectJournal::writeProcessorState(const ValueTree &processorState, const ProcessorStateBlob &stateInformation) {
+    pendingRecords.writeByte(processorStateChanged);
+    writePath(processorState);
+    const ProcessorStateBlob::ScopedRead stateRead(stateInformation);
+    pendingRecords.writeInt64((int64) stateRead.getSize());
+    pendingRecords.write(stateRead.getData(), stateRead.getSize());
+}
+
+void ProjectJournal::writeSnapshot() {
+    // Plugin state is taken from the wrappers' caches, as of the last capture (at most one flush ago),
+    // rather than captured here. Everything else happens on the writer thread.
+    auto snapshot = projectState.createCopy();
+    journaledStateInformation.clear();
+    setCachedProcessorState(snapshot, processorWrappers, journaledStateInformation);
+    journalSize = 0;
+
+    writer.addJob([this, snapshot, directory = directory]() mutable {
+        const auto sessionId = Random::getSystemRandom().nextInt64();
+        snapshot.setProperty(sessionIdProperty, sessionId, nullptr);
+
+        journalStream.reset();
+        directory.createDirectory();
+        if (ProjectFile::write(getSnapshotFile(directory), snapshot, false).failed()) return;
+
+        getJournalFile(directory).deleteFile();
+        journalStream = std::make_unique<FileOutputStream>(getJournalFile(directory));
+        if (journalStream->failedToOpen()) {
+            journalStream.reset();
+            return;
+        }
+        journalStream->writeInt64(sessionId);
+        journalStream->flush();
+    });
+}
+
+void ProjectJournal::writePath(const ValueTree &tree) {
+    Array<int> path;
+    for (auto child = tree; child.isValid() && child != projectState; child = child.getParent())
+        path.add(child.getParent().indexOf(child));
+
+    pendingRecords.writeCompressedInt(path.size());
+    for (int i = path.size() - 1; i >= 0; i--)
+        pendingRecords.writeCompressedInt(path.getUnchecked(i));
+}
+
+void ProjectJournal::valueTreePropertyChanged(ValueTree &tree, const Identifier &property) {
+    if (suspended) return;
+
+    const auto &value = tree[property];
+    // Blobs get set on processors being loaded, copied or deleted, none of which needs them journaled here.
+    // When a processor is (re-)added with its blob, the blob is journaled along with it.
+    if (value.isObject()) return;
+
+    const bool removed = !tree.hasProperty(property);
+    pendingRecords.writeByte(removed ? propertyRemoved : propertyChanged);
+    writePath(tree);
+    pendingRecords.writeString(property.toString());
+    if (!removed)
+        value.writeToStream(pendingRecords);
+}
+
+void ProjectJournal::valueTreeChildAdded(ValueTree &parent, ValueTree &child) {
+    if (suspended) return;
+
+    pendingRecords.writeByte(childAdded);
+    writePath(parent);
+    pendingRecords.writeCompressedInt(parent.indexOf(child));
+    if (containsProcessorStateBlob(child)) {
+        auto serializableChild = child.createCopy();
+        removeProcessorStateBlobs(serializableChild);
+        serializableChild.writeToStream(pendingRecords);
+        journalProcessorStateBlobs(child);
+    } else {
+        child.writeToStream(pendingRecords);
+    }
+}
+
+void ProjectJournal::valueTreeChildRemoved(ValueTree &parent, ValueTree &child, int indexFromWhichChildWasRemoved) {
+    if (suspended) return;
+
+    pendingRecords.writeByte(childRemoved);
+    writePath(parent);
+    pendingRecords.writeCompressedInt(indexFromWhichChildWasRemoved);
+}
+
+void ProjectJournal::valueTreeChildOrderChanged(ValueTree &parent, int oldIndex, int newIndex) {
+    if (suspended) return;
+
+    pendingRecords.writeByte(childMoved);
+    writePath(parent);
+    pendingRecords.writeCompressedInt(oldIndex);
+    pendingRecords.writeCompressedInt(newIndex);
+}
+
+void ProjectJournal::changeListenerCallback(ChangeBroadcaster *source) {
+    // Each undo transaction is journaled as one block.
+    if (source == &undoManager)
+        flushPendingRecords();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "StatefulAudioProcessorWrappers.h"
+
+// Background autosave.
+// Every change to the project state tree is encoded as a compact record. Records are handed to a writer thread
+// once per committed undo transaction (or at least every `flushIntervalMs`), which appends them to a journal file.
+// Plugin state that changed is captured (in the background, where the plugin allows it), and journaled as raw blobs
+// by the first flush after it was captured.
+// When the journal grows past `maxJournalSize`, it's compacted into a full snapshot (a `ProjectFile`) and restarted.
+// Each running instance autosaves into a directory of its own, which it holds a lock on.
+// The autosave files are removed on a clean shutdown, so if an unlocked directory is still around on startup,
+// its session can be recovered.
+struct ProjectJournal : private ValueTree::Listener, private ChangeListener, private Timer {
+    ProjectJournal(ValueTree &projectState, UndoManager &undoManager, StatefulAudioProcessorWrappers &processorWrappers);
+
+    ~ProjectJournal() override;
+
+    // Stop journaling until the next `startNewSession` (e.g. while a project is being loaded).
+    void suspend();
+    // Snapshot the current project state and journal all changes relative to it from here on.
+    void startNewSession();
+
+    // Rebuild the project state of a session that didn't shut down cleanly, from its last snapshot plus its journal.
+    // Its autosave directory is taken over, so the session stays recoverable until this one has journaled it anew.
+    bool recover(ValueTree &recoveredState);
+
+private:
+    static constexpr int flushIntervalMs = 1000;
+    static constexpr int64 maxJournalSize = 4 * 1024 * 1024;
+
+    ValueTree &projectState;
+    UndoManager &undoManager;
+    StatefulAudioProcessorWrappers &processorWrappers;
+
+    // Whether `directory` holds a session this instance journaled (and so may delete on a clean shutdown).
+    bool sessionStarted{false}, suspended{true};
+    MemoryOutputStream pendingRecords;
+
+    // The last journaled state of each processor (as far as it was captured).
+    std::unordered_map<juce::AudioProcessorGraph::NodeID, ProcessorStateBlob::Ptr, NodeIDHash> journaledStateInformation;
+
+    // Only changed before anything is handed to the writer thread.
+    File directory;
+    std::unique_ptr<InterProcessLock> directoryLock;
+
+    ThreadPool writer{1};
+    // Only accessed by the writer thread.
+    std::unique_ptr<FileOutputStream> journalStream;
+    std::atomic<int64> journalSize{0};
+
+    static File getAutosaveDirectory();
+    static std::unique_ptr<InterProcessLock> lockDirectory(const File &directory);
+    static File getSnapshotFile(const File &directory) { return directory.getChildFile("snapshot"); }
+    static File getJournalFile(const File &directory) { return directory.getChildFile("journal"); }
+
+    void flushPendingRecords();
+    void journalChangedProcessorState(const ValueTree &tree);
+    void journalProcessorStateBlobs(const ValueTree &tree);
+    void writeProcessorState(const ValueTree &processorState, const ProcessorStateBlob &stateInformation);
+    void writeSnapshot();
+
+    void writePath(const ValueTree &tree);
+
+    void valueTreePropertyChanged(ValueTree &tree, const Identifier &property) override;
+    void valueTreeChildAdded(ValueTree &parent, ValueTree &child) override;
+    void valueTreeChildRemoved(ValueTree &parent, ValueTree &child, int indexFromWhichChildWasRemoved) override;
+    void valueTreeChildOrderChanged(ValueTree &parent, int oldIndex, int newIndex) override;
+
+    void changeListenerCallback(ChangeBroadcaster *source) override;
+    void timerCallback() override { flushPendingRecords(); }
+};
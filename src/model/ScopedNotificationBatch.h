@@ -0,0 +1,40 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+using namespace juce;
+
+// While at least one of these is alive (on the message thread), `StatefulList`s hold back child-changed
+// and order-changed listener callbacks, deduplicating them per child & property.
+// They're all delivered once the outermost batch goes out of scope.
+//
+// Child added/removed callbacks are never held back, since listeners rely on the child objects
+// they're given being alive (removed children are deleted right after their callback).
+// A list delivers whatever it's holding back right before its next added/removed callback, to keep them in order.
+struct ScopedNotificationBatch {
+    struct Flushable {
+        virtual ~Flushable() { cancel(this); }
+        virtual void flushPendingNotifications() = 0;
+    };
+
+    ScopedNotificationBatch() { depth++; }
+    ~ScopedNotificationBatch() {
+        if (--depth == 0) flush();
+    }
+
+    static bool isActive() { return depth > 0; }
+    static void enqueue(Flushable *flushable) { pending.addIfNotAlreadyThere(flushable); }
+    static void cancel(Flushable *flushable) { pending.removeFirstMatchingValue(flushable); }
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedNotificationBatch)
+
+private:
+    static inline int depth{0};
+    static inline Array<Flushable *> pending;
+
+    static void flush() {
+        // Listeners may make more changes (and even start new batches) while being notified.
+        while (!pending.isEmpty() && depth == 0)
+            pending.removeAndReturn(0)->flushPendingNotifications();
+    }
+};
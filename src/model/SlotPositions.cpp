@@ -0,0 +1,168 @@
+#include "SlotPositions.h"
+
+int SlotPositions::TrackSlots::findFirstSelectedSlot() const {
+    for (int slot : slots)
+        if (isSlotSelected(slot))
+            return slot;
+    return -1;
+}
+
+int SlotPositions::TrackSlots::findLastSelectedSlot() const {
+    for (int i = slots.size() - 1; i >= 0; i--)
+        if (isSlotSelected(slots.getUnchecked(i)))
+            return slots.getUnchecked(i);
+    return -1;
+}
+
+SlotPositions::SlotPositions(const Tracks &tracks, const View &view)
+        : numProcessorSlots(view.getNumProcessorSlots(false)), numMasterProcessorSlots(view.getNumProcessorSlots(true)) {
+    for (const auto *track : tracks.getChildren()) {
+        TrackSlots trackSlots;
+        trackSlots.isSelected = track->isSelected();
+        trackSlots.isMaster = track->isMaster();
+        trackSlots.selectedSlotsMask = track->getSlotMask();
+        for (const auto *processor : track->getProcessorLane()->getChildren())
+            trackSlots.slots.add(processor->getSlot());
+        this->tracks.add(std::move(trackSlots));
+    }
+}
+
+int SlotPositions::getMasterTrackIndex() const {
+    for (int i = 0; i < tracks.size(); i++)
+        if (tracks.getReference(i).isMaster)
+            return i;
+    return -1;
+}
+
+int SlotPositions::findFirstTrackIndexWithSelections() const {
+    for (int i = 0; i < tracks.size(); i++)
+        if (tracks.getReference(i).hasSelections())
+            return i;
+    return -1;
+}
+
+int SlotPositions::findLastTrackIndexWithSelections() const {
+    for (int i = tracks.size() - 1; i >= 0; i--)
+        if (tracks.getReference(i).hasSelections())
+            return i;
+    return -1;
+}
+
+bool SlotPositions::anyTrackSelected() const {
+    for (const auto &track : tracks)
+        if (track.isSelected)
+            return true;
+    return false;
+}
+
+bool SlotPositions::moreThanOneTrackHasSelections() const {
+    return findFirstTrackIndexWithSelections() != findLastTrackIndexWithSelections();
+}
+
+int SlotPositions::limitTrackDelta(int originalTrackDelta, bool anyTrackSelected, bool multipleTracksWithSelections) const {
+    // If more than one track has any selected items, or if any track itself is selected,
+    // don't move any the processors from a non-master track to the master track, or move
+    // a full track into the master track slot.
+    int maxAllowedTrackIndex = anyTrackSelected || multipleTracksWithSelections ? getNumNonMasterTracks() - 1 : tracks.size() - 1;
+    return std::clamp(originalTrackDelta, -findFirstTrackIndexWithSelections(), maxAllowedTrackIndex - findLastTrackIndexWithSelections());
+}
+
+static int lastNonSelectedSlotLessThan(const SlotPositions::TrackSlots &track, int slot) {
+    for (int i = track.slots.size() - 1; i >= 0; i--) {
+        int otherSlot = track.slots.getUnchecked(i);
+        if (otherSlot < slot && !track.isSlotSelected(otherSlot))
+            return otherSlot;
+    }
+    return -1;
+}
+
+static Array<int> getFirstSlotInEachContiguousSelectedGroup(const SlotPositions::TrackSlots &track) {
+    Array<int> firstSlotInEachContiguousSelectedGroup;
+    int lastSelectedProcessorSlot = -2;
+    for (int slot : track.slots) {
+        if (slot > lastSelectedProcessorSlot + 1 && track.isSlotSelected(slot)) {
+            lastSelectedProcessorSlot = slot;
+            firstSlotInEachContiguousSelectedGroup.add(slot);
+        }
+    }
+    return firstSlotInEachContiguousSelectedGroup;
+}
+
+int SlotPositions::limitSlotDelta(int originalSlotDelta, int limitedTrackDelta) const {
+    int limitedSlotDelta = originalSlotDelta;
+    for (int fromTrackIndex = 0; fromTrackIndex < tracks.size(); fromTrackIndex++) {
+        const auto &fromTrack = tracks.getReference(fromTrackIndex);
+        if (fromTrack.isSelected) continue; // entire track will be moved, so it shouldn't restrict other slot movements
+
+        int lastSelectedSlot = fromTrack.findLastSelectedSlot();
+        if (lastSelectedSlot == -1) continue; // no processors to move
+
+        const auto *toTrack = getTrack(fromTrackIndex + limitedTrackDelta);
+        int firstSelectedSlot = fromTrack.findFirstSelectedSlot(); // valid since lastSelected is valid
+        int maxAllowedSlot = getNumProcessorSlots(toTrack->isMaster) - 1;
+        limitedSlotDelta = std::clamp(limitedSlotDelta, -firstSelectedSlot, maxAllowedSlot - lastSelectedSlot);
+
+        // ---------- Expand processor movement while limiting dynamic processor row creation ---------- //
+
+        // If this move would add new processor rows, make sure we're doing it for good reason!
+        // Only force new rows to be added if the selected group is being explicitly dragged to underneath
+        // at least one processor.
+        //
+        // Find the largest slot-delta, less than the original given slot-delta, such that a contiguous selected
+        // group in the pre-move track would end up completely below a non-selected processor in
+        // the post-move track.
+        for (int slot : getFirstSlotInEachContiguousSelectedGroup(fromTrack)) {
+            int lastNonSelectedSlot = lastNonSelectedSlotLessThan(*toTrack, slot + originalSlotDelta);
+            if (lastNonSelectedSlot != -1) {
+                int candidateSlotDelta = lastNonSelectedSlot + 1 - slot;
+                if (candidateSlotDelta <= originalSlotDelta)
+                    limitedSlotDelta = std::max(limitedSlotDelta, candidateSlotDelta);
+            }
+        }
+    }
+
+    return limitedSlotDelta;
+}
+
+// This is done in three phases.
+// * _Handle edge cases_, such as when both master-track and non-master-tracks have selections.
+// * _Limit_ the track/slot-delta to the obvious left/right/top/bottom boundaries
+// * _Expand_ the slot-delta just enough to allow groups of selected processors to move below non-selected processors,
+//   while only creating new processor rows if necessary.
+juce::Point<int> SlotPositions::limitMoveDelta(juce::Point<int> fromTrackAndSlot, juce::Point<int> toTrackAndSlot) const {
+    auto originalDelta = toTrackAndSlot - fromTrackAndSlot;
+    bool multipleTracksWithSelections = moreThanOneTrackHasSelections();
+    // In the special case that multiple tracks have selections and the master track is one of them,
+    // disallow movement because it doesn't make sense dragging horizontally and vertically at the same time.
+    const auto *masterTrack = getTrack(getMasterTrackIndex());
+    if (multipleTracksWithSelections && masterTrack != nullptr && masterTrack->hasSelections())
+        return {0, 0};
+
+    // When dragging from a non-master track to the master track, interpret as dragging beyond the y-limit,
+    // to whatever track slot corresponding to the master track x-position (x/y is flipped in master track).
+    if (multipleTracksWithSelections) {
+        const auto *fromTrack = getTrack(fromTrackAndSlot.x);
+        const auto *toTrack = getTrack(toTrackAndSlot.x);
+        if ((fromTrack == nullptr || fromTrack->isMaster) &&
+            (toTrack != nullptr && toTrack->isMaster)) {
+            originalDelta = {toTrackAndSlot.y - fromTrackAndSlot.x, getNumProcessorSlots(false) - 1 - fromTrackAndSlot.y};
+        }
+    }
+
+    int limitedTrackDelta = limitTrackDelta(originalDelta.x, anyTrackSelected(), multipleTracksWithSelections);
+    if (fromTrackAndSlot.y == -1) // track-move only
+        return {limitedTrackDelta, 0};
+
+    int limitedSlotDelta = limitSlotDelta(originalDelta.y, limitedTrackDelta);
+    return {limitedTrackDelta, limitedSlotDelta};
+}
+
+bool SlotPositions::isMoveTarget(juce::Point<int> moveDelta, juce::Point<int> trackAndSlot) const {
+    const auto *fromTrack = getTrack(trackAndSlot.x - moveDelta.x);
+    if (fromTrack == nullptr) return false;
+    // Selected tracks move with all of their processors, without changing their slots.
+    if (fromTrack->isSelected) return fromTrack->slots.contains(trackAndSlot.y);
+
+    const int fromSlot = trackAndSlot.y - moveDelta.y;
+    return fromTrack->isSlotSelected(fromSlot) && fromTrack->slots.contains(fromSlot);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Tracks.h"
+#include "View.h"
+
+// A lightweight value snapshot of which slots each track's processors occupy, and what's selected.
+// Used to work out drag-move previews without touching (and notifying listeners of) the real project state.
+struct SlotPositions {
+    struct TrackSlots {
+        bool isSelected{false}, isMaster{false};
+        Array<int> slots; // processor slots, in lane order
+        BigInteger selectedSlotsMask;
+
+        bool isSlotSelected(int slot) const { return selectedSlotsMask[slot]; }
+        bool hasSelections() const { return isSelected || selectedSlotsMask.getHighestBit() != -1; }
+        int findFirstSelectedSlot() const;
+        int findLastSelectedSlot() const;
+    };
+
+    SlotPositions() = default;
+    SlotPositions(const Tracks &tracks, const View &view);
+
+    // The delta that moving the current selection from one grid position to another would _actually_ result in,
+    // after limiting it to the track/slot boundaries. (See `MoveSelectedItems`.)
+    juce::Point<int> limitMoveDelta(juce::Point<int> fromTrackAndSlot, juce::Point<int> toTrackAndSlot) const;
+    // Whether a selected processor would end up in the given track/slot after a move by the given (limited) delta.
+    bool isMoveTarget(juce::Point<int> moveDelta, juce::Point<int> trackAndSlot) const;
+
+private:
+    Array<TrackSlots> tracks;
+    int numProcessorSlots{0}, numMasterProcessorSlots{0};
+
+    const TrackSlots *getTrack(int trackIndex) const { return isPositiveAndBelow(trackIndex, tracks.size()) ? &tracks.getReference(trackIndex) : nullptr; }
+    int getNumProcessorSlots(bool isMaster) const { return isMaster ? numMasterProcessorSlots : numProcessorSlots; }
+    int getMasterTrackIndex() const;
+    int getNumNonMasterTracks() const { return getMasterTrackIndex() != -1 ? tracks.size() - 1 : tracks.size(); }
+    int findFirstTrackIndexWithSelections() const;
+    int findLastTrackIndexWithSelections() const;
+    bool anyTrackSelected() const;
+    bool moreThanOneTrackHasSelections() const;
+
+    int limitTrackDelta(int originalTrackDelta, bool anyTrackSelected, bool multipleTracksWithSelections) const;
+    int limitSlotDelta(int originalSlotDelta, int limitedTrackDelta) const;
+};
@@ -1,30 +1,28 @@
 #include "StatefulAudioProcessorWrappers.h"
 
+StatefulAudioProcessorWrappers::~StatefulAudioProcessorWrappers() {
+    for (auto &nodeIdAndStateCaptureJob : stateCaptureJobs)
+        workerPool.removeJob(nodeIdAndStateCaptureJob.second.get(), true, -1);
+}
+
 ValueTree StatefulAudioProcessorWrappers::saveProcessorInformationToState(Processor *processor) const {
     if (auto *processorWrapper = getProcessorWrapperForProcessor(processor)) {
-        if (auto *audioProcessor = processorWrapper->audioProcessor) {
-            MemoryBlock memoryBlock;
-            audioProcessor->getStateInformation(memoryBlock);
-            processor->setProcessorState(memoryBlock.toBase64Encoding());
-            return processor->getState();
-        }
+        processor->setProcessorStateBlob(processorWrapper->getStateInformation());
+        return processor->getState();
     }
     return {};
 }
 
 void StatefulAudioProcessorWrappers::saveProcessorStateInformationToState(ValueTree &processorState) const {
     if (auto *processorWrapper = getProcessorWrapperForState(processorState)) {
-        if (auto *audioProcessor = processorWrapper->audioProcessor) {
-            MemoryBlock memoryBlock;
-            audioProcessor->getStateInformation(memoryBlock);
-            Processor::setProcessorState(processorState, memoryBlock.toBase64Encoding());
-        }
+        Processor::setProcessorStateBlob(processorState, processorWrapper->getStateInformation());
     }
 }
 
-ValueTree StatefulAudioProcessorWrappers::copyProcessor(ValueTree &fromProcessor) const {
-    saveProcessorStateInformationToState(fromProcessor);
+ValueTree StatefulAudioProcessorWrappers::copyProcessor(const ValueTree &fromProcessor) const {
+    // The copy refers to the same immutable state blob as the original's cache (and so do all copies made from it).
     auto copiedProcessor = fromProcessor.createCopy();
+    saveProcessorStateInformationToState(copiedProcessor);
     copiedProcessor.removeProperty(ProcessorIDs::nodeId, nullptr);
     return copiedProcessor;
 }
@@ -35,3 +33,64 @@ bool StatefulAudioProcessorWrappers::flushAllParameterValuesToValueTree() {
             return true;
     return false;
 }
+
+void StatefulAudioProcessorWrappers::captureAllStateInformation() {
+    std::atomic<int> numPendingJobs{0};
+    WaitableEvent allJobsFinished;
+    for (auto &nodeIdAndProcessorWrapper : processorWrapperForNodeId) {
+        auto *processorWrapper = nodeIdAndProcessorWrapper.second.get();
+        if (!processorWrapper->isStateInformationDirty() || !processorWrapper->canGetStateInformationOffMessageThread()) continue;
+
+        numPendingJobs++;
+        workerPool.addJob([processorWrapper, &numPendingJobs, &allJobsFinished] {
+            processorWrapper->getStateInformation();
+            if (--numPendingJobs == 0) allJobsFinished.signal();
+        });
+    }
+    // Capture the rest here while the pool works through the others.
+    for (auto &nodeIdAndProcessorWrapper : processorWrapperForNodeId) {
+        auto *processorWrapper = nodeIdAndProcessorWrapper.second.get();
+        if (processorWrapper->isStateInformationDirty() && !processorWrapper->canGetStateInformationOffMessageThread())
+            processorWrapper->getStateInformation();
+    }
+    while (numPendingJobs > 0)
+        allJobsFinished.wait();
+}
+
+void StatefulAudioProcessorWrappers::captureAllStateInformationInBackground() {
+    for (auto &nodeIdAndProcessorWrapper : processorWrapperForNodeId) {
+        auto *processorWrapper = nodeIdAndProcessorWrapper.second.get();
+        if (!processorWrapper->isStateInformationDirty()) continue;
+
+        if (!processorWrapper->canGetStateInformationOffMessageThread()) {
+            processorWrapper->getStateInformation();
+            continue;
+        }
+        auto &stateCaptureJob = stateCaptureJobs[nodeIdAndProcessorWrapper.first];
+        if (stateCaptureJob == nullptr)
+            stateCaptureJob = std::make_unique<StateCaptureJob>(*processorWrapper);
+        // Unless it's still (waiting to be) captured from last time.
+        if (!workerPool.contains(stateCaptureJob.get()))
+            workerPool.addJob(stateCaptureJob.get(), false);
+    }
+}
+
+bool StatefulAudioProcessorWrappers::anyStateInformationCacheDiffers(const std::unordered_map<juce::AudioProcessorGraph::NodeID, ProcessorStateBlob::Ptr, NodeIDHash> &stateInformation) const {
+    for (const auto &nodeIdAndProcessorWrapper : processorWrapperForNodeId) {
+        const auto stateInformationCache = nodeIdAndProcessorWrapper.second->getStateInformationCache();
+        if (stateInformationCache == nullptr) continue;
+
+        const auto nodeIdAndStateInformation = stateInformation.find(nodeIdAndProcessorWrapper.first);
+        if (nodeIdAndStateInformation == stateInformation.end() || nodeIdAndStateInformation->second != stateInformationCache)
+            return true;
+    }
+    return false;
+}
+
+void StatefulAudioProcessorWrappers::removeStateCaptureJob(juce::AudioProcessorGraph::NodeID nodeId) {
+    auto nodeIdAndStateCaptureJob = stateCaptureJobs.find(nodeId);
+    if (nodeIdAndStateCaptureJob == stateCaptureJobs.end()) return;
+
+    workerPool.removeJob(nodeIdAndStateCaptureJob->second.get(), true, -1);
+    stateCaptureJobs.erase(nodeIdAndStateCaptureJob);
+}
@@ -6,6 +6,11 @@
 #include "Processor.h"
 
 struct StatefulAudioProcessorWrappers {
+    // Stale caches of plugins that allow it are captured on `workerPool` (shared with the rest of the app).
+    explicit StatefulAudioProcessorWrappers(ThreadPool &workerPool) : workerPool(workerPool) {}
+
+    ~StatefulAudioProcessorWrappers();
+
     unsigned long size() const { return processorWrapperForNodeId.size(); }
 
     StatefulAudioProcessorWrapper *getProcessorWrapperForNodeId(juce::AudioProcessorGraph::NodeID nodeId) const {
@@ -31,13 +36,44 @@ struct StatefulAudioProcessorWrappers {
         return {};
     }
 
-    void set(juce::AudioProcessorGraph::NodeID nodeId, std::unique_ptr<StatefulAudioProcessorWrapper> processorWrapper) { processorWrapperForNodeId[nodeId] = std::move(processorWrapper); }
-    void erase(juce::AudioProcessorGraph::NodeID nodeId) { processorWrapperForNodeId.erase(nodeId); }
+    void set(juce::AudioProcessorGraph::NodeID nodeId, std::unique_ptr<StatefulAudioProcessorWrapper> processorWrapper) {
+        removeStateCaptureJob(nodeId);
+        processorWrapperForNodeId[nodeId] = std::move(processorWrapper);
+    }
+    void erase(juce::AudioProcessorGraph::NodeID nodeId) {
+        removeStateCaptureJob(nodeId);
+        processorWrapperForNodeId.erase(nodeId);
+    }
     ValueTree saveProcessorInformationToState(Processor *processor) const;
     void saveProcessorStateInformationToState(ValueTree &processorState) const;
-    ValueTree copyProcessor(ValueTree &fromProcessor) const;
+    ValueTree copyProcessor(const ValueTree &fromProcessor) const;
     bool flushAllParameterValuesToValueTree();
+    // Bring the state caches of all processors that changed since their last capture up to date.
+    // Plugins that allow it are captured in parallel.
+    void captureAllStateInformation();
+    // Same, without waiting for the plugins that allow capturing off the message thread.
+    // Their caches are updated in the background, whenever their capture finishes.
+    void captureAllStateInformationInBackground();
+    // Whether any processor's cached state is other than the given one (e.g. the last state written somewhere).
+    bool anyStateInformationCacheDiffers(const std::unordered_map<juce::AudioProcessorGraph::NodeID, ProcessorStateBlob::Ptr, NodeIDHash> &stateInformation) const;
 
 private:
-    std::map<juce::AudioProcessorGraph::NodeID, std::unique_ptr<StatefulAudioProcessorWrapper> > processorWrapperForNodeId;
+    // Captures a wrapper's state on the worker pool. Removed (and waited for) before its wrapper goes away.
+    struct StateCaptureJob : public ThreadPoolJob {
+        explicit StateCaptureJob(StatefulAudioProcessorWrapper &processorWrapper) : ThreadPoolJob("Capture plugin state"), processorWrapper(processorWrapper) {}
+
+        JobStatus runJob() override {
+            processorWrapper.getStateInformation();
+            return jobHasFinished;
+        }
+
+    private:
+        StatefulAudioProcessorWrapper &processorWrapper;
+    };
+
+    ThreadPool &workerPool;
+    std::unordered_map<juce::AudioProcessorGraph::NodeID, std::unique_ptr<StatefulAudioProcessorWrapper>, NodeIDHash> processorWrapperForNodeId;
+    std::unordered_map<juce::AudioProcessorGraph::NodeID, std::unique_ptr<StateCaptureJob>, NodeIDHash> stateCaptureJobs;
+
+    void removeStateCaptureJob(juce::AudioProcessorGraph::NodeID nodeId);
 };
@@ -2,13 +2,15 @@
 
 #include <juce_core/juce_core.h>
 #include <juce_data_structures/juce_data_structures.h>
+#include <unordered_set>
 #include "Stateful.h"
+#include "ScopedNotificationBatch.h"
 
 using namespace juce;
 
 // TODO merge with Stateful
 template<typename ObjectType>
-struct StatefulList : protected ValueTree::Listener {
+struct StatefulList : protected ValueTree::Listener, private ScopedNotificationBatch::Flushable {
     struct Listener {
         virtual void onChildAdded(ObjectType *child) {}
         virtual void onChildRemoved(ObjectType *child, int oldIndex) {}
@@ -93,6 +95,9 @@ protected:
     // call in the sub-class when being destroyed
     void freeObjects() {
         parent.removeListener(this);
+        ScopedNotificationBatch::cancel(this);
+        pendingChildChanges.clear();
+        pendingChildChangeSet.clear();
         deleteAllObjects();
     }
 
@@ -118,6 +123,7 @@ protected:
 
     void valueTreeChildAdded(ValueTree &, ValueTree &tree) override {
         if (isChildTree(tree)) {
+            flushPendingNotificationsNow();
             const int index = parent.indexOf(tree);
             if (ObjectType *newObject = createNewObject(tree)) {
                 if (index == parent.getNumChildren() - 1)
@@ -135,6 +141,8 @@ protected:
         if (parent == exParent && isChildType(tree)) {
             const int oldIndex = indexOf(tree);
             if (oldIndex >= 0) {
+                // Including the child's own changes, while it's still around.
+                flushPendingNotificationsNow();
                 auto *child = children.removeAndReturn(oldIndex);
                 listeners.call(&Listener::onChildRemoved, child, oldIndex);
                 // Not correct but doesn't leave dangling pointers
@@ -150,7 +158,12 @@ protected:
         if (tree == parent) {
             children.sort(*this);
             onOrderChanged();
-            listeners.call(&Listener::onOrderChanged);
+            if (ScopedNotificationBatch::isActive()) {
+                orderChangePending = true;
+                ScopedNotificationBatch::enqueue(this);
+            } else {
+                listeners.call(&Listener::onOrderChanged);
+            }
         }
     }
 
@@ -158,10 +171,56 @@ protected:
         if (isChildTree(tree)) {
             auto *child = getChildForState(tree);
             onChildChanged(child, i);
-            listeners.call(&Listener::onChildChanged, child, i);
+            if (ScopedNotificationBatch::isActive()) {
+                if (!pendingChildChangeSet.insert({child, i}).second) return;
+
+                pendingChildChanges.add({child, i});
+                ScopedNotificationBatch::enqueue(this);
+            } else {
+                listeners.call(&Listener::onChildChanged, child, i);
+            }
         }
     }
 
 private:
+    struct ChildChange {
+        ObjectType *child;
+        Identifier property;
+
+        bool operator==(const ChildChange &other) const { return child == other.child && property == other.property; }
+    };
+
+    struct ChildChangeHash {
+        size_t operator()(const ChildChange &change) const {
+            // Identifiers are pooled, so their character pointers are unique.
+            return std::hash<ObjectType *>()(change.child) ^ (std::hash<const void *>()(change.property.getCharPointer().getAddress()) << 1);
+        }
+    };
+
+    // In the order they happened, and as a set for deduplicating them.
+    Array<ChildChange> pendingChildChanges;
+    std::unordered_set<ChildChange, ChildChangeHash> pendingChildChangeSet;
+    bool orderChangePending{false};
+
+    // Added/removed callbacks aren't held back. Deliver whatever is, first, so listeners still see changes in order.
+    void flushPendingNotificationsNow() {
+        if (!orderChangePending && pendingChildChanges.isEmpty()) return;
+
+        ScopedNotificationBatch::cancel(this);
+        flushPendingNotifications();
+    }
+
+    void flushPendingNotifications() override {
+        if (orderChangePending) {
+            orderChangePending = false;
+            listeners.call(&Listener::onOrderChanged);
+        }
+        Array<ChildChange> childChanges;
+        childChanges.swapWith(pendingChildChanges);
+        pendingChildChangeSet.clear();
+        for (const auto &change : childChanges)
+            listeners.call(&Listener::onChildChanged, change.child, change.property);
+    }
+
     void deleteChild(ObjectType *child) { delete child; }
 };
@@ -1,8 +1,9 @@
 #pragma once
 
 #include "DefaultAudioProcessor.h"
+#include "GainStageProcessor.h"
 
-class BalanceProcessor : public DefaultAudioProcessor {
+class BalanceProcessor : public DefaultAudioProcessor, public GainStageProcessor {
 public:
     explicit BalanceProcessor() :
             DefaultAudioProcessor(getPluginDescription()),
@@ -33,25 +34,11 @@ public:
     }
 
     void processBlock(AudioSampleBuffer &buffer, MidiBuffer &midiMessages) override {
-        if (buffer.getNumChannels() == 2) {
-            // 0db at center, linear stereo balance control
-            // http://www.kvraudio.com/forum/viewtopic.php?t=148865
-            for (int i = 0; i < buffer.getNumSamples(); i++) {
-                const float balanceValue = balance.getNextValue();
-
-                float leftChannelGain, rightChannelGain;
-                if (balanceValue < 0.0) {
-                    leftChannelGain = 1;
-                    rightChannelGain = 1 + balanceValue;
-                } else {
-                    leftChannelGain = 1 - balanceValue;
-                    rightChannelGain = 1;
-                }
-
-                buffer.setSample(0, i, buffer.getSample(0, i) * leftChannelGain);
-                buffer.setSample(1, i, buffer.getSample(1, i) * rightChannelGain);
-            }
-        }
+        processGainStage(buffer, midiMessages);
+    }
+
+    void accumulateGains(float *leftGains, float *rightGains, int numSamples, bool isStereo) override {
+        accumulateBalance(balance, leftGains, rightGains, numSamples, isStereo);
     }
 
 private:
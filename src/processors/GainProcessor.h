@@ -1,8 +1,9 @@
 #pragma once
 
 #include "DefaultAudioProcessor.h"
+#include "GainStageProcessor.h"
 
-class GainProcessor : public DefaultAudioProcessor {
+class GainProcessor : public DefaultAudioProcessor, public GainStageProcessor {
 public:
     explicit GainProcessor() :
             DefaultAudioProcessor(getPluginDescription()),
@@ -32,7 +33,11 @@ public:
     }
 
     void processBlock(AudioSampleBuffer &buffer, MidiBuffer &midiMessages) override {
-        gain.applyGain(buffer, buffer.getNumSamples());
+        processGainStage(buffer, midiMessages);
+    }
+
+    void accumulateGains(float *leftGains, float *rightGains, int numSamples, bool isStereo) override {
+        accumulateGain(gain, leftGains, rightGains, numSamples);
     }
 
 private:
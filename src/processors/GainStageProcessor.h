@@ -0,0 +1,75 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "view/parameter_control/level_meter/LevelMeterSource.h"
+
+using namespace juce;
+
+// An internal stereo processor whose audio processing is nothing but a (smoothed) gain per channel.
+// A chain of these is rendered as one fused kernel (see `GraphRenderSequence`): every stage multiplies its
+// per-sample gains into a pair of small, cache-resident gain arrays, and the block is then scaled in a single pass.
+struct GainStageProcessor {
+    virtual ~GainStageProcessor() = default;
+
+    // Multiply this stage's next `numSamples` left & right gains into `leftGains` & `rightGains`, advancing any smoothing.
+    // Balance only applies to stereo audio (`isStereo`), like it always has.
+    virtual void accumulateGains(float *leftGains, float *rightGains, int numSamples, bool isStereo) = 0;
+    virtual void processGainStageMidi(MidiBuffer &midiMessages) {}
+    // Whether this stage can currently be fused at all (e.g. not while it needs to see the actual audio).
+    virtual bool canFuse() const { return true; }
+    // Metered stages can only end a fused chain, since their meter needs the audio as it leaves the stage.
+    virtual LevelMeterSource *getStageMeterSource() { return nullptr; }
+
+    // Gain arrays are filled in chunks of this many samples.
+    static constexpr int maxChunkSize = 256;
+
+    static void accumulateGain(LinearSmoothedValue<float> &gain, float *leftGains, float *rightGains, int numSamples) {
+        if (!gain.isSmoothing()) {
+            FloatVectorOperations::multiply(leftGains, gain.getTargetValue(), numSamples);
+            FloatVectorOperations::multiply(rightGains, gain.getTargetValue(), numSamples);
+            return;
+        }
+        for (int i = 0; i < numSamples; i++) {
+            const float gainValue = gain.getNextValue();
+            leftGains[i] *= gainValue;
+            rightGains[i] *= gainValue;
+        }
+    }
+
+    // 0db at center, linear stereo balance control
+    // http://www.kvraudio.com/forum/viewtopic.php?t=148865
+    static void accumulateBalance(LinearSmoothedValue<float> &balance, float *leftGains, float *rightGains, int numSamples, bool isStereo) {
+        if (!isStereo) return;
+
+        for (int i = 0; i < numSamples; i++) {
+            const float balanceValue = balance.getNextValue();
+            if (balanceValue < 0.0) {
+                rightGains[i] *= 1 + balanceValue;
+            } else {
+                leftGains[i] *= 1 - balanceValue;
+            }
+        }
+    }
+
+    // Scale channel 1 of `buffer` by `rightGains`, and every other channel by `leftGains` (`numSamples` long, starting at `startSample`).
+    // (Unless `buffer` is stereo, no balance was applied, so both are the same.)
+    static void applyGains(AudioBuffer<float> &buffer, int startSample, const float *leftGains, const float *rightGains, int numSamples) {
+        for (int channel = 0; channel < buffer.getNumChannels(); channel++)
+            FloatVectorOperations::multiply(buffer.getWritePointer(channel, startSample), channel == 1 ? rightGains : leftGains, numSamples);
+    }
+
+    // Process this stage on its own, when it isn't part of a fused chain.
+    void processGainStage(AudioBuffer<float> &buffer, MidiBuffer &midiMessages) {
+        float leftGains[maxChunkSize], rightGains[maxChunkSize];
+        for (int startSample = 0; startSample < buffer.getNumSamples(); startSample += maxChunkSize) {
+            const int numSamples = jmin(maxChunkSize, buffer.getNumSamples() - startSample);
+            FloatVectorOperations::fill(leftGains, 1.0f, numSamples);
+            FloatVectorOperations::fill(rightGains, 1.0f, numSamples);
+            accumulateGains(leftGains, rightGains, numSamples, buffer.getNumChannels() == 2);
+            applyGains(buffer, startSample, leftGains, rightGains, numSamples);
+        }
+        processGainStageMidi(midiMessages);
+        if (auto *meterSource = getStageMeterSource())
+            meterSource->measureBlock(buffer);
+    }
+};
@@ -27,6 +27,7 @@ public:
     static bool isMidiOutputProcessor(const String &name);
     static bool isIoProcessor(const String &name);
     static bool isTrackIOProcessor(const String &name);
+    static bool isInternalPlugin(const PluginDescription &description) { return description.pluginFormatName == "Internal"; }
     static String getTrackInputProcessorName();
     static String getTrackOutputProcessorName();
     static String getMidiInputProcessorName();
@@ -1,9 +1,10 @@
 #pragma once
 
 #include "DefaultAudioProcessor.h"
+#include "GainStageProcessor.h"
 #include "view/parameter_control/level_meter/LevelMeter.h"
 
-class MixerChannelProcessor : public DefaultAudioProcessor {
+class MixerChannelProcessor : public DefaultAudioProcessor, public GainStageProcessor {
 public:
     explicit MixerChannelProcessor() :
             DefaultAudioProcessor(getPluginDescription()),
@@ -42,29 +43,16 @@ public:
     }
 
     void processBlock(AudioSampleBuffer &buffer, MidiBuffer &midiMessages) override {
-        if (buffer.getNumChannels() == 2) {
-            // 0db at center, linear stereo balance control
-            // http://www.kvraudio.com/forum/viewtopic.php?t=148865
-            for (int i = 0; i < buffer.getNumSamples(); i++) {
-                const float balanceValue = balance.getNextValue();
-
-                float leftChannelGain, rightChannelGain;
-                if (balanceValue < 0.0) {
-                    leftChannelGain = 1;
-                    rightChannelGain = 1 + balanceValue;
-                } else {
-                    leftChannelGain = 1 - balanceValue;
-                    rightChannelGain = 1;
-                }
+        processGainStage(buffer, midiMessages);
+    }
 
-                buffer.setSample(0, i, buffer.getSample(0, i) * leftChannelGain);
-                buffer.setSample(1, i, buffer.getSample(1, i) * rightChannelGain);
-            }
-        }
-        gain.applyGain(buffer, buffer.getNumSamples());
-        meterSource.measureBlock(buffer);
+    void accumulateGains(float *leftGains, float *rightGains, int numSamples, bool isStereo) override {
+        accumulateBalance(balance, leftGains, rightGains, numSamples, isStereo);
+        accumulateGain(gain, leftGains, rightGains, numSamples);
     }
 
+    LevelMeterSource *getStageMeterSource() override { return &meterSource; }
+
     LevelMeterSource *getMeterSource() override { return &meterSource; }
     AudioProcessorParameter *getMeteredParameter() override { return gainParameter; }
 
@@ -0,0 +1,173 @@
+#include "OutOfProcessPluginHost.h"
+
+using namespace OutOfProcessPluginIPC;
+
+OutOfProcessPluginHost::OutOfProcessPluginHost() : Thread("Out-of-process plugin") {
+    formatManager.addDefaultFormats();
+}
+
+OutOfProcessPluginHost::~OutOfProcessPluginHost() {
+    stopProcessing();
+}
+
+void OutOfProcessPluginHost::handleMessageFromCoordinator(const MemoryBlock &message) {
+    // Plugins expect to be created and controlled from the message thread.
+    MessageManager::callAsync([this, message] {
+        MemoryInputStream request(message, false);
+        // Every reply starts with the ID of the request it answers.
+        const int requestId = request.readInt();
+        MemoryOutputStream reply;
+        reply.writeInt(requestId);
+        reply << handleMessage(request);
+        sendMessageToCoordinator(reply.getMemoryBlock());
+    });
+}
+
+void OutOfProcessPluginHost::handleConnectionLost() {
+    JUCEApplicationBase::quit();
+}
+
+MemoryBlock OutOfProcessPluginHost::handleMessage(MemoryInputStream &request) {
+    MemoryOutputStream reply;
+    switch (request.readInt()) {
+        case MessageType::create: {
+            PluginDescription description;
+            if (auto descriptionXml = parseXML(request.readString()))
+                description.loadFromXml(*descriptionXml);
+            const double sampleRate = request.readDouble();
+            const int blockSize = request.readInt();
+            MemoryBlock state;
+            request.readIntoMemoryBlock(state, request.readInt());
+
+            String errorMessage;
+            plugin = formatManager.createPluginInstance(description, sampleRate, blockSize, errorMessage);
+            reply.writeBool(plugin != nullptr);
+            if (plugin == nullptr) {
+                reply.writeString(errorMessage);
+                break;
+            }
+            if (!state.isEmpty())
+                plugin->setStateInformation(state.getData(), (int) state.getSize());
+
+            reply.writeBool(plugin->acceptsMidi());
+            reply.writeBool(plugin->producesMidi());
+            reply.writeDouble(plugin->getTailLengthSeconds());
+            const auto &parameters = plugin->getParameters();
+            const int numParameters = jmin(parameters.size(), maxParameters);
+            reply.writeInt(numParameters);
+            for (int i = 0; i < numParameters; i++) {
+                const auto *parameter = parameters.getUnchecked(i);
+                reply.writeString(parameter->getName(64));
+                reply.writeString(parameter->getLabel());
+                reply.writeFloat(parameter->getDefaultValue());
+                reply.writeInt(parameter->getNumSteps());
+                reply.writeBool(parameter->isDiscrete());
+                reply.writeBool(parameter->isBoolean());
+            }
+            writeParameterValues(reply);
+            break;
+        }
+        case MessageType::prepare: {
+            stopProcessing();
+            const auto sharedMemoryName = request.readString();
+            numChannels = request.readInt();
+            const double sampleRate = request.readDouble();
+            maxBlockSize = request.readInt();
+
+            sharedMemory = SharedMemory::open(sharedMemoryName, SharedState::getSize(numChannels, maxBlockSize));
+            reply.writeBool(sharedMemory != nullptr && plugin != nullptr);
+            if (sharedMemory == nullptr || plugin == nullptr) break;
+
+            plugin->setPlayConfigDetails(plugin->getTotalNumInputChannels(), plugin->getTotalNumOutputChannels(), sampleRate, maxBlockSize);
+            plugin->prepareToPlay(sampleRate, maxBlockSize);
+            reply.writeInt(plugin->getLatencySamples());
+            appliedParameterValues.resize(jmin(plugin->getParameters().size(), maxParameters));
+            resyncParameterValues = true;
+            startThread(realtimeAudioPriority);
+            break;
+        }
+        case MessageType::release:
+            stopProcessing();
+            if (plugin != nullptr)
+                plugin->releaseResources();
+            break;
+        case MessageType::getState: {
+            MemoryBlock state;
+            if (plugin != nullptr)
+                plugin->getStateInformation(state);
+            reply.writeInt((int) state.getSize());
+            reply.write(state.getData(), state.getSize());
+            break;
+        }
+        case MessageType::setState: {
+            MemoryBlock state;
+            request.readIntoMemoryBlock(state, request.readInt());
+            if (plugin != nullptr) {
+                // Keep the audio thread out of the plugin while its state is replaced.
+                const ScopedLock callbackLock(plugin->getCallbackLock());
+                plugin->setStateInformation(state.getData(), (int) state.getSize());
+            }
+            writeParameterValues(reply);
+            break;
+        }
+        default:
+            break;
+    }
+    return reply.getMemoryBlock();
+}
+
+void OutOfProcessPluginHost::writeParameterValues(MemoryOutputStream &reply) {
+    const auto &parameters = plugin->getParameters();
+    const int numParameters = jmin(parameters.size(), maxParameters);
+    reply.writeInt(numParameters);
+    for (int i = 0; i < numParameters; i++)
+        reply.writeFloat(parameters.getUnchecked(i)->getValue());
+    // The app sends back whatever the plugin just reported. Don't apply that as a change.
+    resyncParameterValues = true;
+}
+
+void OutOfProcessPluginHost::stopProcessing() {
+    stopThread(1000);
+    sharedMemory.reset();
+}
+
+void OutOfProcessPluginHost::run() {
+    auto *sharedState = getSharedState();
+    Array<float *> channels;
+    for (int channel = 0; channel < numChannels; channel++)
+        channels.add(sharedState->getChannel(channel, maxBlockSize));
+    MidiBuffer midiBuffer;
+    auto completedBlock = sharedState->completedBlock.load(std::memory_order_acquire);
+
+    while (!threadShouldExit()) {
+        if (!waitWhileEqual(sharedState->requestedBlock, completedBlock, 100)) continue;
+
+        const auto requestedBlock = sharedState->requestedBlock.load(std::memory_order_acquire);
+        {
+            const ScopedLock callbackLock(plugin->getCallbackLock());
+            const auto &parameters = plugin->getParameters();
+            const int numParameters = jmin(parameters.size(), appliedParameterValues.size());
+            if (resyncParameterValues.exchange(false)) {
+                for (int i = 0; i < numParameters; i++)
+                    appliedParameterValues.setUnchecked(i, sharedState->parameterValues[i]);
+            }
+            for (int i = 0; i < numParameters; i++) {
+                const float value = sharedState->parameterValues[i];
+                if (value != appliedParameterValues.getUnchecked(i)) {
+                    parameters.getUnchecked(i)->setValue(value);
+                    appliedParameterValues.setUnchecked(i, value);
+                }
+            }
+
+            AudioBuffer<float> buffer(channels.getRawDataPointer(), numChannels, jlimit(0, maxBlockSize, sharedState->numSamples));
+            midiBuffer.clear();
+            sharedState->midiIn.read(midiBuffer);
+            plugin->processBlock(buffer, midiBuffer);
+            sharedState->midiOut.write(midiBuffer);
+        }
+
+        completedBlock = requestedBlock;
+        sharedState->completedBlock.store(completedBlock, std::memory_order_release);
+        wakeAll(sharedState->completedBlock);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "OutOfProcessPluginIPC.h"
+
+// The plugin host child process side of an `OutOfProcessPluginInstance`.
+// Hosts a single plugin. Control messages are handled on the message thread,
+// and audio blocks are processed on a realtime thread of their own as soon as the app hands them over.
+class OutOfProcessPluginHost : public ChildProcessWorker, private Thread {
+public:
+    OutOfProcessPluginHost();
+    ~OutOfProcessPluginHost() override;
+
+    void handleMessageFromCoordinator(const MemoryBlock &message) override;
+    void handleConnectionLost() override;
+
+private:
+    AudioPluginFormatManager formatManager;
+    std::unique_ptr<AudioPluginInstance> plugin;
+
+    std::unique_ptr<OutOfProcessPluginIPC::SharedMemory> sharedMemory;
+    int numChannels{0}, maxBlockSize{0};
+    // Only accessed by the processing thread once it's running.
+    Array<float> appliedParameterValues;
+    std::atomic<bool> resyncParameterValues{true};
+
+    MemoryBlock handleMessage(MemoryInputStream &request);
+    void writeParameterValues(MemoryOutputStream &reply);
+    void stopProcessing();
+
+    OutOfProcessPluginIPC::SharedState *getSharedState() const { return static_cast<OutOfProcessPluginIPC::SharedState *>(sharedMemory->getData()); }
+
+    void run() override;
+};
@@ -0,0 +1,139 @@
+#include "OutOfProcessPluginIPC.h"
+
+#if JUCE_LINUX || JUCE_MAC
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if JUCE_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#if JUCE_MAC
+// The (stable since macOS 10.12) primitive behind the system's own atomic waits. The shared variants work across processes.
+extern "C" int __ulock_wait(uint32_t operation, void *address, uint64_t value, uint32_t timeoutMicroseconds);
+extern "C" int __ulock_wake(uint32_t operation, void *address, uint64_t wakeValue);
+static constexpr uint32_t UL_COMPARE_AND_WAIT_SHARED = 3;
+static constexpr uint32_t ULF_WAKE_ALL = 0x00000100;
+#endif
+
+namespace OutOfProcessPluginIPC {
+std::unique_ptr<SharedMemory> SharedMemory::create(const String &name, size_t size) {
+#if JUCE_LINUX || JUCE_MAC
+    const int fd = shm_open(name.toRawUTF8(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return {};
+
+    void *data = ftruncate(fd, (off_t) size) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (data == MAP_FAILED) {
+        shm_unlink(name.toRawUTF8());
+        return {};
+    }
+    return std::unique_ptr<SharedMemory>(new SharedMemory(name, data, size, true));
+#else
+    ignoreUnused(name, size);
+    return {};
+#endif
+}
+
+std::unique_ptr<SharedMemory> SharedMemory::open(const String &name, size_t size) {
+#if JUCE_LINUX || JUCE_MAC
+    const int fd = shm_open(name.toRawUTF8(), O_RDWR, 0600);
+    if (fd < 0) return {};
+
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return {};
+
+    return std::unique_ptr<SharedMemory>(new SharedMemory(name, data, size, false));
+#else
+    ignoreUnused(name, size);
+    return {};
+#endif
+}
+
+SharedMemory::~SharedMemory() {
+#if JUCE_LINUX || JUCE_MAC
+    munmap(data, size);
+    if (isOwner)
+        shm_unlink(name.toRawUTF8());
+#endif
+}
+
+void MidiRing::writeBytes(uint32 position, const void *bytes, uint32 numBytes) {
+    for (uint32 i = 0; i < numBytes; i++)
+        data[(position + i) % capacity] = static_cast<const uint8 *>(bytes)[i];
+}
+
+void MidiRing::readBytes(uint32 position, void *bytes, uint32 numBytes) const {
+    for (uint32 i = 0; i < numBytes; i++)
+        static_cast<uint8 *>(bytes)[i] = data[(position + i) % capacity];
+}
+
+void MidiRing::write(const MidiBuffer &midiBuffer) {
+    auto position = writePosition.load(std::memory_order_relaxed);
+    const auto readFrom = readPosition.load(std::memory_order_acquire);
+    for (const auto metadata : midiBuffer) {
+        const int header[2]{metadata.samplePosition, metadata.numBytes};
+        const auto eventSize = (uint32) (sizeof(header) + (size_t) metadata.numBytes);
+        if (capacity - (position - readFrom) < eventSize) break;
+
+        writeBytes(position, header, sizeof(header));
+        writeBytes(position + (uint32) sizeof(header), metadata.data, (uint32) metadata.numBytes);
+        position += eventSize;
+    }
+    writePosition.store(position, std::memory_order_release);
+}
+
+void MidiRing::read(MidiBuffer &midiBuffer) {
+    auto position = readPosition.load(std::memory_order_relaxed);
+    const auto writtenTo = writePosition.load(std::memory_order_acquire);
+    uint8 messageData[256];
+    while (position != writtenTo) {
+        const auto numBytesLeft = writtenTo - position;
+        int header[2];
+        if (numBytesLeft > capacity || numBytesLeft < sizeof(header)) break;
+
+        readBytes(position, header, sizeof(header));
+        if (header[1] < 0 || (uint32) header[1] > numBytesLeft - sizeof(header)) break;
+
+        const auto numBytes = (uint32) header[1];
+        // Longer events (big SysEx dumps) are dropped rather than passed along cut off.
+        if (numBytes <= sizeof(messageData)) {
+            readBytes(position + (uint32) sizeof(header), messageData, numBytes);
+            midiBuffer.addEvent(messageData, (int) numBytes, jmax(0, header[0]));
+        }
+        position += (uint32) sizeof(header) + numBytes;
+    }
+    readPosition.store(writtenTo, std::memory_order_release);
+}
+
+bool waitWhileEqual(const std::atomic<uint32> &value, uint32 expected, double timeoutMs) {
+    const auto deadline = Time::getMillisecondCounterHiRes() + timeoutMs;
+    while (value.load(std::memory_order_acquire) == expected) {
+        const auto remainingMs = deadline - Time::getMillisecondCounterHiRes();
+        if (remainingMs <= 0) return false;
+#if JUCE_LINUX
+        // Not `FUTEX_PRIVATE_FLAG`: the other side is a different process.
+        timespec timeout{(time_t) (remainingMs / 1000), (long) (std::fmod(remainingMs, 1000.0) * 1000000)};
+        syscall(SYS_futex, reinterpret_cast<const uint32 *>(&value), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#elif JUCE_MAC
+        __ulock_wait(UL_COMPARE_AND_WAIT_SHARED, const_cast<uint32 *>(reinterpret_cast<const uint32 *>(&value)), expected,
+                     (uint32_t) jmax(1.0, remainingMs * 1000));
+#endif
+    }
+    return true;
+}
+
+void wakeAll(const std::atomic<uint32> &value) {
+#if JUCE_LINUX
+    syscall(SYS_futex, reinterpret_cast<const uint32 *>(&value), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#elif JUCE_MAC
+    __ulock_wake(UL_COMPARE_AND_WAIT_SHARED | ULF_WAKE_ALL, const_cast<uint32 *>(reinterpret_cast<const uint32 *>(&value)), 0);
+#else
+    ignoreUnused(value);
+#endif
+}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+using namespace juce;
+
+// What the app (`OutOfProcessPluginInstance`) and the plugin host child process (`OutOfProcessPluginHost`) share.
+// Control messages (create, prepare, state, ...) go over the child process connection.
+// Audio, MIDI and parameter values go through a shared memory region, with one block handed back and forth per `processBlock`.
+namespace OutOfProcessPluginIPC {
+#if JUCE_LINUX || JUCE_MAC
+static constexpr bool isSupported = true;
+#else
+static constexpr bool isSupported = false;
+#endif
+
+static constexpr const char *childProcessCommandLineUID = "flowGridPluginHost";
+
+enum MessageType : int { create, prepare, release, getState, setState };
+
+static constexpr int maxParameters = 1024;
+
+// POSIX shared memory, created (and unlinked again) by the app, and mapped by the plugin host process.
+struct SharedMemory {
+    static std::unique_ptr<SharedMemory> create(const String &name, size_t size);
+    static std::unique_ptr<SharedMemory> open(const String &name, size_t size);
+
+    ~SharedMemory();
+
+    void *getData() const { return data; }
+
+private:
+    SharedMemory(const String &name, void *data, size_t size, bool isOwner) : name(name), data(data), size(size), isOwner(isOwner) {}
+
+    const String name;
+    void *data;
+    const size_t size;
+    const bool isOwner;
+};
+
+// Single-producer, single-consumer ring of MIDI events, living in shared memory.
+struct MidiRing {
+    // Events that don't fit are dropped.
+    void write(const MidiBuffer &midiBuffer);
+    // The other process writes the ring, so everything it reads is checked first.
+    // Everything left is dropped as soon as an event doesn't add up (e.g. after the other process crashed mid-write).
+    void read(MidiBuffer &midiBuffer);
+
+private:
+    static constexpr uint32 capacity = 32 * 1024;
+
+    std::atomic<uint32> writePosition{0}, readPosition{0};
+    uint8 data[capacity];
+
+    void writeBytes(uint32 position, const void *bytes, uint32 numBytes);
+    void readBytes(uint32 position, void *bytes, uint32 numBytes) const;
+};
+
+// The start of the shared memory region. The audio channels follow it, `maxBlockSize` samples each.
+// The app bumps `requestedBlock` once it has filled in a block, the host process processes the channels in place
+// and sets `completedBlock` to the same number when done. Whoever's turn it is owns everything else in the region.
+struct SharedState {
+    std::atomic<uint32> requestedBlock{0}, completedBlock{0};
+    int numSamples{0};
+    MidiRing midiIn, midiOut;
+    float parameterValues[maxParameters]{};
+
+    float *getChannel(int channel, int maxBlockSize) { return reinterpret_cast<float *>(this + 1) + (size_t) channel * (size_t) maxBlockSize; }
+
+    static size_t getSize(int numChannels, int maxBlockSize) { return sizeof(SharedState) + sizeof(float) * (size_t) numChannels * (size_t) maxBlockSize; }
+};
+
+static_assert(std::atomic<uint32>::is_always_lock_free, "Shared memory signaling needs lock-free atomics");
+
+// Block (up to `timeoutMs`, which can be a fraction of a millisecond) until `value` is no longer `expected`.
+// Works across processes. Returns false on timeout.
+bool waitWhileEqual(const std::atomic<uint32> &value, uint32 expected, double timeoutMs);
+// Wake up everyone waiting on `value`.
+void wakeAll(const std::atomic<uint32> &value);
+}
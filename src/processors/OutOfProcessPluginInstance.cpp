@@ -0,0 +1,390 @@
+#include "OutOfProcessPluginInstance.h"
+
+#include <unordered_map>
+
+using namespace OutOfProcessPluginIPC;
+
+static constexpr int connectionTimeoutMs = 10000;
+static constexpr int createTimeoutMs = 30000;
+static constexpr int requestTimeoutMs = 10000;
+// State is captured off the message thread, where it can take a while. The message thread never waits long for it.
+static constexpr int stateRequestTimeoutMs = 2000, messageThreadStateRequestTimeoutMs = 250;
+// The share of a block's duration the host process gets to process it. A block it misses is output as silence,
+// leaving the rest of the block period to the rest of the graph.
+static constexpr double processTimeoutBlockFraction = 0.25;
+
+struct OutOfProcessPluginInstance::Connection : private ChildProcessCoordinator {
+    explicit Connection(OutOfProcessPluginInstance &owner) : owner(owner) {}
+
+    bool launch() {
+        return launchWorkerProcess(File::getSpecialLocation(File::currentExecutableFile), childProcessCommandLineUID, connectionTimeoutMs);
+    }
+
+    bool isConnectionLost() const { return connectionLost; }
+
+    // Requests (from any thread) are sent one at a time. Each carries an ID the host process echoes back with its reply,
+    // so a late reply to an earlier request that timed out is never taken for the reply to the current one.
+    bool sendRequest(MemoryOutputStream &request, MemoryBlock &reply, int timeoutMs) {
+        const ScopedLock requestScopedLock(requestLock);
+        uint32 requestId;
+        {
+            const ScopedLock scopedLock(replyLock);
+            requestId = awaitedRequestId = ++lastRequestId;
+            hasReply = false;
+        }
+        replyReceived.reset();
+        if (!sendMessage(requestId, request))
+            return false;
+
+        replyReceived.wait(timeoutMs);
+        const ScopedLock scopedLock(replyLock);
+        if (!hasReply || connectionLost) return false;
+
+        reply = std::move(this->reply);
+        return true;
+    }
+
+    // Send a request (from any thread) without waiting for its reply. `onReply` is called with it on the connection's thread.
+    // Doesn't wait for requests still waiting for their replies either. The host process handles requests in the order they're sent.
+    bool sendRequestAsync(MemoryOutputStream &request, std::function<void(const MemoryBlock &)> onReply) {
+        uint32 requestId;
+        {
+            const ScopedLock scopedLock(replyLock);
+            requestId = ++lastRequestId;
+            asyncReplyHandlers[requestId] = std::move(onReply);
+        }
+        if (sendMessage(requestId, request)) return true;
+
+        const ScopedLock scopedLock(replyLock);
+        asyncReplyHandlers.erase(requestId);
+        return false;
+    }
+
+private:
+    OutOfProcessPluginInstance &owner;
+    CriticalSection requestLock;
+    WaitableEvent replyReceived;
+    CriticalSection replyLock;
+    uint32 lastRequestId{0}, awaitedRequestId{0};
+    bool hasReply{false};
+    MemoryBlock reply;
+    std::unordered_map<uint32, std::function<void(const MemoryBlock &)>> asyncReplyHandlers;
+    std::atomic<bool> connectionLost{false};
+
+    bool sendMessage(uint32 requestId, MemoryOutputStream &request) {
+        MemoryOutputStream message;
+        message.writeInt((int) requestId);
+        message << request.getMemoryBlock();
+        return !connectionLost && sendMessageToWorker(message.getMemoryBlock());
+    }
+
+    void handleMessageFromWorker(const MemoryBlock &message) override {
+        if (message.getSize() < sizeof(int32)) return;
+
+        const MemoryBlock replyData(static_cast<const char *>(message.getData()) + sizeof(int32), message.getSize() - sizeof(int32));
+        std::function<void(const MemoryBlock &)> onReply;
+        {
+            const ScopedLock scopedLock(replyLock);
+            MemoryInputStream stream(message, false);
+            const auto requestId = (uint32) stream.readInt();
+            if (auto asyncReplyHandler = asyncReplyHandlers.find(requestId); asyncReplyHandler != asyncReplyHandlers.end()) {
+                onReply = std::move(asyncReplyHandler->second);
+                asyncReplyHandlers.erase(asyncReplyHandler);
+            } else {
+                if (requestId != awaitedRequestId || hasReply) return;
+
+                reply = replyData;
+                hasReply = true;
+            }
+        }
+        if (onReply != nullptr)
+            onReply(replyData);
+        else
+            replyReceived.signal();
+    }
+
+    void handleConnectionLost() override {
+        connectionLost = true;
+        replyReceived.signal();
+        owner.triggerAsyncUpdate();
+    }
+};
+
+// Mirrors a parameter of the hosted plugin. Values are passed along to the plugin with each block.
+struct OutOfProcessPluginInstance::Parameter : public AudioProcessorParameter {
+    Parameter(String name, String label, float defaultValue, int numSteps, bool discrete, bool boolean)
+            : name(std::move(name)), label(std::move(label)), defaultValue(defaultValue), value(defaultValue),
+              numSteps(numSteps), discrete(discrete), boolean(boolean) {}
+
+    float getValue() const override { return value; }
+    void setValue(float newValue) override { value = newValue; }
+    float getDefaultValue() const override { return defaultValue; }
+    String getName(int maximumStringLength) const override { return name.substring(0, maximumStringLength); }
+    String getLabel() const override { return label; }
+    int getNumSteps() const override { return numSteps; }
+    bool isDiscrete() const override { return discrete; }
+    bool isBoolean() const override { return boolean; }
+    float getValueForText(const String &text) const override { return text.getFloatValue(); }
+
+private:
+    const String name, label;
+    const float defaultValue;
+    std::atomic<float> value;
+    const int numSteps;
+    const bool discrete, boolean;
+};
+
+static AudioProcessor::BusesProperties getBusesProperties(const PluginDescription &description) {
+    AudioProcessor::BusesProperties busesProperties;
+    if (description.numInputChannels > 0)
+        busesProperties = busesProperties.withInput("Input", AudioChannelSet::canonicalChannelSet(description.numInputChannels));
+    if (description.numOutputChannels > 0)
+        busesProperties = busesProperties.withOutput("Output", AudioChannelSet::canonicalChannelSet(description.numOutputChannels));
+    return busesProperties;
+}
+
+OutOfProcessPluginInstance::OutOfProcessPluginInstance(const PluginDescription &description, double sampleRate, int blockSize)
+        : AudioPluginInstance(getBusesProperties(description)), description(description) {
+    setRateAndBufferSizeDetails(sampleRate, blockSize);
+    loaded = launch(sampleRate, blockSize);
+}
+
+OutOfProcessPluginInstance::~OutOfProcessPluginInstance() {
+    connection.reset();
+    cancelPendingUpdate();
+    parameterValuesUpdater.cancelPendingUpdate();
+    sharedMemory.reset();
+}
+
+bool OutOfProcessPluginInstance::launch(double sampleRate, int blockSize) {
+    connection = std::make_unique<Connection>(*this);
+    if (!connection->launch()) {
+        errorMessage = TRANS("Could not start the plugin host process");
+        return false;
+    }
+
+    MemoryOutputStream request;
+    request.writeInt(MessageType::create);
+    request.writeString(description.createXml()->toString());
+    request.writeDouble(sampleRate);
+    request.writeInt(blockSize);
+    {
+        const ScopedLock stateScopedLock(stateLock);
+        request.writeInt((int) lastKnownState.getSize());
+        request.write(lastKnownState.getData(), lastKnownState.getSize());
+    }
+
+    MemoryBlock replyData;
+    if (!connection->sendRequest(request, replyData, createTimeoutMs)) {
+        errorMessage = TRANS("The plugin host process stopped responding");
+        return false;
+    }
+
+    MemoryInputStream reply(replyData, false);
+    if (!reply.readBool()) {
+        errorMessage = reply.readString();
+        return false;
+    }
+
+    pluginAcceptsMidi = reply.readBool();
+    pluginProducesMidi = reply.readBool();
+    tailLengthSeconds = reply.readDouble();
+    const int numParameters = reply.readInt();
+    // A restarted plugin has the same parameters as before.
+    const bool addParameters = getParameters().isEmpty();
+    for (int i = 0; i < numParameters; i++) {
+        auto name = reply.readString();
+        auto label = reply.readString();
+        const float defaultValue = reply.readFloat();
+        const int numSteps = reply.readInt();
+        const bool discrete = reply.readBool();
+        const bool boolean = reply.readBool();
+        if (addParameters)
+            addParameter(new Parameter(std::move(name), std::move(label), defaultValue, numSteps, discrete, boolean));
+    }
+    readParameterValues(reply);
+    return true;
+}
+
+bool OutOfProcessPluginInstance::prepareHost(double sampleRate, int blockSize) {
+    sharedMemory.reset();
+    numSharedChannels = jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
+    maxBlockSize = blockSize;
+    processTimeoutMs = processTimeoutBlockFraction * 1000.0 * blockSize / sampleRate;
+
+    const auto sharedMemoryName = "/fg" + String::toHexString(Random::getSystemRandom().nextInt64());
+    sharedMemory = SharedMemory::create(sharedMemoryName, SharedState::getSize(numSharedChannels, maxBlockSize));
+    if (sharedMemory == nullptr) return false;
+
+    new(sharedMemory->getData()) SharedState();
+
+    MemoryOutputStream request;
+    request.writeInt(MessageType::prepare);
+    request.writeString(sharedMemoryName);
+    request.writeInt(numSharedChannels);
+    request.writeDouble(sampleRate);
+    request.writeInt(blockSize);
+
+    MemoryBlock replyData;
+    if (connection->sendRequest(request, replyData, requestTimeoutMs)) {
+        MemoryInputStream reply(replyData, false);
+        if (reply.readBool()) {
+            setLatencySamples(reply.readInt());
+            return true;
+        }
+    }
+    sharedMemory.reset();
+    return false;
+}
+
+void OutOfProcessPluginInstance::readParameterValues(MemoryInputStream &reply) {
+    const auto &parameters = getParameters();
+    const int numValues = reply.readInt();
+    for (int i = 0; i < numValues; i++) {
+        const float value = reply.readFloat();
+        if (auto *parameter = parameters[i])
+            if (parameter->getValue() != value)
+                parameter->setValueNotifyingHost(value);
+    }
+}
+
+bool OutOfProcessPluginInstance::restart() {
+    // Launching the new host process blocks until it has created the plugin.
+    JUCE_ASSERT_MESSAGE_THREAD
+    if (connection != nullptr && !connection->isConnectionLost()) {
+        MemoryBlock state;
+        getStateInformation(state);
+    }
+
+    // Waits for any state requests (e.g. a capture on a worker thread) still using the old connection.
+    const ScopedWriteLock scopedLock(connectionLock);
+    suspendProcessing(true);
+    sharedMemory.reset();
+    connection.reset();
+    // Killing the old host process doesn't count as a crash.
+    cancelPendingUpdate();
+    loaded = launch(getSampleRate(), getBlockSize());
+    if (loaded && isPrepared)
+        isPrepared = prepareHost(getSampleRate(), getBlockSize());
+    suspendProcessing(false);
+    return loaded;
+}
+
+void OutOfProcessPluginInstance::handleAsyncUpdate() {
+    // The host process crashed. Don't keep restarting a plugin that crashes right away, though.
+    if (numAutomaticRestarts++ < maxAutomaticRestarts)
+        restart();
+}
+
+void OutOfProcessPluginInstance::prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) {
+    isPrepared = loaded && prepareHost(sampleRate, maximumExpectedSamplesPerBlock);
+}
+
+void OutOfProcessPluginInstance::releaseResources() {
+    if (isPrepared && !connection->isConnectionLost()) {
+        MemoryOutputStream request;
+        request.writeInt(MessageType::release);
+        MemoryBlock reply;
+        connection->sendRequest(request, reply, requestTimeoutMs);
+    }
+    sharedMemory.reset();
+    isPrepared = false;
+}
+
+void OutOfProcessPluginInstance::processBlock(AudioBuffer<float> &buffer, MidiBuffer &midiMessages) {
+    auto *sharedState = sharedMemory != nullptr ? static_cast<SharedState *>(sharedMemory->getData()) : nullptr;
+    const int numSamples = buffer.getNumSamples();
+    const auto requestedBlock = sharedState != nullptr ? sharedState->requestedBlock.load(std::memory_order_relaxed) : 0;
+    // Also skip blocks while the host process is still busy with one that missed its deadline.
+    if (sharedState == nullptr || connection->isConnectionLost() || numSamples > maxBlockSize ||
+        sharedState->completedBlock.load(std::memory_order_acquire) != requestedBlock) {
+        buffer.clear();
+        midiMessages.clear();
+        return;
+    }
+
+    for (int channel = 0; channel < numSharedChannels; channel++) {
+        if (channel < buffer.getNumChannels())
+            FloatVectorOperations::copy(sharedState->getChannel(channel, maxBlockSize), buffer.getReadPointer(channel), numSamples);
+        else
+            FloatVectorOperations::clear(sharedState->getChannel(channel, maxBlockSize), numSamples);
+    }
+    sharedState->numSamples = numSamples;
+    sharedState->midiIn.write(midiMessages);
+    midiMessages.clear();
+    const auto &parameters = getParameters();
+    for (int i = 0; i < jmin(parameters.size(), maxParameters); i++)
+        sharedState->parameterValues[i] = parameters.getUnchecked(i)->getValue();
+
+    sharedState->requestedBlock.store(requestedBlock + 1, std::memory_order_release);
+    wakeAll(sharedState->requestedBlock);
+    if (!waitWhileEqual(sharedState->completedBlock, requestedBlock, processTimeoutMs)) {
+        buffer.clear();
+        return;
+    }
+
+    for (int channel = 0; channel < jmin(numSharedChannels, buffer.getNumChannels()); channel++)
+        buffer.copyFrom(channel, 0, sharedState->getChannel(channel, maxBlockSize), numSamples);
+    sharedState->midiOut.read(midiMessages);
+}
+
+void OutOfProcessPluginInstance::getStateInformation(MemoryBlock &destData) {
+    const ScopedReadLock scopedLock(connectionLock);
+    if (loaded && !connection->isConnectionLost()) {
+        MemoryOutputStream request;
+        request.writeInt(MessageType::getState);
+        MemoryBlock replyData;
+        const auto timeoutMs = MessageManager::existsAndIsCurrentThread() ? messageThreadStateRequestTimeoutMs : stateRequestTimeoutMs;
+        if (connection->sendRequest(request, replyData, timeoutMs)) {
+            MemoryInputStream reply(replyData, false);
+            MemoryBlock state;
+            reply.readIntoMemoryBlock(state, reply.readInt());
+            const ScopedLock stateScopedLock(stateLock);
+            lastKnownState = std::move(state);
+        }
+    }
+    // Otherwise, the last known state is the best there is.
+    const ScopedLock stateScopedLock(stateLock);
+    destData = lastKnownState;
+}
+
+void OutOfProcessPluginInstance::setStateInformation(const void *data, int sizeInBytes) {
+    {
+        const ScopedLock stateScopedLock(stateLock);
+        lastKnownState.replaceAll(data, (size_t) sizeInBytes);
+    }
+    const ScopedReadLock scopedLock(connectionLock);
+    if (!loaded || connection->isConnectionLost()) return;
+
+    MemoryOutputStream request;
+    request.writeInt(MessageType::setState);
+    request.writeInt(sizeInBytes);
+    request.write(data, (size_t) sizeInBytes);
+    // The message thread doesn't wait for the plugin. Its parameter values follow once the host process has restored it.
+    if (MessageManager::existsAndIsCurrentThread()) {
+        connection->sendRequestAsync(request, [this](const MemoryBlock &replyData) {
+            {
+                const ScopedLock stateScopedLock(stateLock);
+                restoredParameterValues = replyData;
+            }
+            parameterValuesUpdater.triggerAsyncUpdate();
+        });
+        return;
+    }
+
+    MemoryBlock replyData;
+    if (connection->sendRequest(request, replyData, stateRequestTimeoutMs)) {
+        MemoryInputStream reply(replyData, false);
+        readParameterValues(reply);
+    }
+}
+
+void OutOfProcessPluginInstance::applyRestoredParameterValues() {
+    MemoryBlock replyData;
+    {
+        const ScopedLock stateScopedLock(stateLock);
+        replyData.swapWith(restoredParameterValues);
+    }
+    MemoryInputStream reply(replyData, false);
+    readParameterValues(reply);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "OutOfProcessPluginIPC.h"
+
+// A plugin running in a child process of its own (this app, launched as an `OutOfProcessPluginHost`),
+// presented to the graph as a normal `AudioPluginInstance`.
+// Each `processBlock` hands its block to the host process through shared memory and waits for it to come back.
+// If the host process crashes or misses the deadline for a block (a fraction of the block's duration), this outputs silence
+// instead of taking the session down, and a crashed host process is restarted with the last known plugin state.
+// Getting and setting the plugin state is safe from any thread. The message thread never waits long for either.
+class OutOfProcessPluginInstance : public AudioPluginInstance, private AsyncUpdater {
+public:
+    OutOfProcessPluginInstance(const PluginDescription &description, double sampleRate, int blockSize);
+    ~OutOfProcessPluginInstance() override;
+
+    // Check this after construction, like `AudioPluginFormat::createPluginInstance` returning `nullptr`.
+    bool isLoaded() const { return loaded; }
+    const String &getErrorMessage() const { return errorMessage; }
+
+    // Kill the plugin host process (if it's still running) and start a fresh one, restored to the last known plugin state.
+    // Message thread only: it waits for the new host process to create the plugin.
+    bool restart();
+
+    void fillInPluginDescription(PluginDescription &description) const override { description = this->description; }
+    const String getName() const override { return description.name; }
+
+    void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void processBlock(AudioBuffer<float> &buffer, MidiBuffer &midiMessages) override;
+
+    double getTailLengthSeconds() const override { return tailLengthSeconds; }
+    bool acceptsMidi() const override { return pluginAcceptsMidi; }
+    bool producesMidi() const override { return pluginProducesMidi; }
+
+    // The plugin's editor would have to live in the other process.
+    bool hasEditor() const override { return false; }
+    AudioProcessorEditor *createEditor() override { return nullptr; }
+
+    int getNumPrograms() override { return 1; }
+    int getCurrentProgram() override { return 0; }
+    void setCurrentProgram(int) override {}
+    const String getProgramName(int) override { return {}; }
+    void changeProgramName(int, const String &) override {}
+
+    void getStateInformation(MemoryBlock &destData) override;
+    void setStateInformation(const void *data, int sizeInBytes) override;
+
+private:
+    struct Connection;
+    struct Parameter;
+
+    static constexpr int maxAutomaticRestarts = 3;
+
+    const PluginDescription description;
+    std::unique_ptr<Connection> connection;
+    bool loaded{false};
+    String errorMessage;
+    bool pluginAcceptsMidi{false}, pluginProducesMidi{false};
+    double tailLengthSeconds{0};
+    int numAutomaticRestarts{0};
+
+    // Held (for reading) while using `connection` off the message thread, and (for writing) while replacing it.
+    ReadWriteLock connectionLock;
+    // Guards `lastKnownState` and `restoredParameterValues`.
+    CriticalSection stateLock;
+    // Restored into a restarted host process.
+    MemoryBlock lastKnownState;
+    // The host process's reply to the latest `setStateInformation` from the message thread.
+    MemoryBlock restoredParameterValues;
+
+    // Applies `restoredParameterValues` on the message thread.
+    struct ParameterValuesUpdater : public AsyncUpdater {
+        explicit ParameterValuesUpdater(OutOfProcessPluginInstance &instance) : instance(instance) {}
+        void handleAsyncUpdate() override { instance.applyRestoredParameterValues(); }
+
+    private:
+        OutOfProcessPluginInstance &instance;
+    } parameterValuesUpdater{*this};
+
+    std::unique_ptr<OutOfProcessPluginIPC::SharedMemory> sharedMemory;
+    int numSharedChannels{0}, maxBlockSize{0};
+    double processTimeoutMs{0};
+    bool isPrepared{false};
+
+    bool launch(double sampleRate, int blockSize);
+    bool prepareHost(double sampleRate, int blockSize);
+    void readParameterValues(MemoryInputStream &reply);
+    void applyRestoredParameterValues();
+
+    void handleAsyncUpdate() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutOfProcessPluginInstance)
+};
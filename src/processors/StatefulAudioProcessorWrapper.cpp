@@ -1,6 +1,7 @@
 #include "StatefulAudioProcessorWrapper.h"
 
 #include "DefaultAudioProcessor.h"
+#include "OutOfProcessPluginInstance.h"
 
 StatefulAudioProcessorWrapper::Parameter::Parameter(AudioProcessorParameter *parameter, StatefulAudioProcessorWrapper *processorWrapper)
         : AudioProcessorParameterWithID(parameter->getName(32), parameter->getName(32),
@@ -345,9 +346,11 @@ StatefulAudioProcessorWrapper::StatefulAudioProcessorWrapper(AudioPluginInstance
     //  If we're loading from state, bypass state needs to make its way to the processor graph to actually mute.
     processor->getState().sendPropertyChangeMessage(ProcessorIDs::bypassed);
     audioProcessor->addListener(processor);
+    audioProcessor->addListener(this);
 }
 
 StatefulAudioProcessorWrapper::~StatefulAudioProcessorWrapper() {
+    audioProcessor->removeListener(this);
     automatableParameters.clear(false);
 }
 
@@ -363,5 +366,36 @@ bool StatefulAudioProcessorWrapper::flushParameterValuesToValueTree() {
         }
     }
 
+    if (anythingUpdated) stateInformationDirty = true;
     return anythingUpdated;
 }
+
+ProcessorStateBlob::Ptr StatefulAudioProcessorWrapper::getStateInformation() {
+    const ScopedLock captureLock(stateInformationCaptureLock);
+    // Clear the flag first, so a change that happens while capturing is picked up next time.
+    if (stateInformationDirty.exchange(false) || getStateInformationCache() == nullptr) {
+        MemoryBlock memoryBlock;
+        audioProcessor->getStateInformation(memoryBlock);
+        ProcessorStateBlob::Ptr stateInformation = new MemoryProcessorStateBlob(std::move(memoryBlock));
+        const SpinLock::ScopedLockType cacheLock(stateInformationCacheLock);
+        stateInformationCache = stateInformation;
+    }
+    return getStateInformationCache();
+}
+
+void StatefulAudioProcessorWrapper::setStateInformationCache(ProcessorStateBlob::Ptr stateInformation) {
+    const ScopedLock captureLock(stateInformationCaptureLock);
+    stateInformationDirty = stateInformation == nullptr;
+    const SpinLock::ScopedLockType cacheLock(stateInformationCacheLock);
+    stateInformationCache = std::move(stateInformation);
+}
+
+void StatefulAudioProcessorWrapper::setStateInformation(const void *data, int sizeInBytes) {
+    audioProcessor->setStateInformation(data, sizeInBytes);
+    stateInformationDirty = true;
+}
+
+bool StatefulAudioProcessorWrapper::canGetStateInformationOffMessageThread() const {
+    return InternalPluginFormat::isInternalPlugin(audioProcessor->getPluginDescription()) ||
+           dynamic_cast<OutOfProcessPluginInstance *>(audioProcessor) != nullptr;
+}
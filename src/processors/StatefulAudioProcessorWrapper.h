@@ -9,7 +9,7 @@
 #include "view/parameter_control/level_meter/LevelMeterSource.h"
 #include "view/processor_editor/SwitchParameterComponent.h"
 
-struct StatefulAudioProcessorWrapper {
+struct StatefulAudioProcessorWrapper : private AudioProcessorListener {
     struct Parameter
             : public AudioProcessorParameterWithID,
               private ValueTree::Listener,
@@ -115,7 +115,7 @@ struct StatefulAudioProcessorWrapper {
 
     StatefulAudioProcessorWrapper(AudioPluginInstance *audioProcessor, Processor *processor, UndoManager &undoManager);
 
-    ~StatefulAudioProcessorWrapper();
+    ~StatefulAudioProcessorWrapper() override;
 
     juce::AudioProcessorGraph::NodeID getNodeId() const { return nodeId; }
 
@@ -127,6 +127,25 @@ struct StatefulAudioProcessorWrapper {
 
     bool flushParameterValuesToValueTree();
 
+    // The plugin's state, only re-captured if anything changed it since the last time.
+    // Captures are one at a time, but can happen on any thread the plugin allows (see `canGetStateInformationOffMessageThread`).
+    ProcessorStateBlob::Ptr getStateInformation();
+    bool isStateInformationDirty() const { return stateInformationDirty; }
+    // The last captured state, without capturing it again (`nullptr` if it was never captured).
+    ProcessorStateBlob::Ptr getStateInformationCache() const {
+        const SpinLock::ScopedLockType cacheLock(stateInformationCacheLock);
+        return stateInformationCache;
+    }
+    // Use when the plugin's state was just restored from `stateInformation`.
+    void setStateInformationCache(ProcessorStateBlob::Ptr stateInformation);
+    // Restore state into the running plugin (e.g. a preset), marking its cache stale.
+    void setStateInformation(const void *data, int sizeInBytes);
+    // Internal processors can be captured from any thread, and out-of-process plugins are only asked through IPC
+    // (their host process calls the plugin on its own message thread).
+    // Plugins hosted in this process are only captured on the message thread, since plugin formats don't allow
+    // calling `getStateInformation` from anywhere else, and many plugins' state isn't safe to read concurrently.
+    bool canGetStateInformationOffMessageThread() const;
+
     AudioPluginInstance *audioProcessor;
 
 private:
@@ -136,4 +155,13 @@ private:
     OwnedArray<Parameter> automatableParameters;
 
     CriticalSection valueTreeChanging;
+
+    // Set by parameter and processor change callbacks (which can come from any thread), and by `setStateInformation`.
+    std::atomic<bool> stateInformationDirty{true};
+    CriticalSection stateInformationCaptureLock;
+    mutable SpinLock stateInformationCacheLock;
+    ProcessorStateBlob::Ptr stateInformationCache;
+
+    void audioProcessorParameterChanged(AudioProcessor *, int, float) override { stateInformationDirty = true; }
+    void audioProcessorChanged(AudioProcessor *, const ChangeDetails &) override { stateInformationDirty = true; }
 };
@@ -1,9 +1,10 @@
 #pragma once
 
 #include "DefaultAudioProcessor.h"
+#include "GainStageProcessor.h"
 #include "view/parameter_control/level_meter/LevelMeter.h"
 
-class TrackInputProcessor : public DefaultAudioProcessor {
+class TrackInputProcessor : public DefaultAudioProcessor, public GainStageProcessor {
 public:
     explicit TrackInputProcessor() :
             DefaultAudioProcessor(getPluginDescription()),
@@ -41,7 +42,14 @@ public:
     }
 
     void processBlock(AudioSampleBuffer &buffer, MidiBuffer &midiMessages) override {
-        gain.applyGain(buffer, buffer.getNumSamples());
+        processGainStage(buffer, midiMessages);
+    }
+
+    void accumulateGains(float *leftGains, float *rightGains, int numSamples, bool isStereo) override {
+        accumulateGain(gain, leftGains, rightGains, numSamples);
+    }
+
+    void processGainStageMidi(MidiBuffer &midiMessages) override {
         if (!monitorMidiParameter->get())
             midiMessages.clear();
     }
@@ -1,9 +1,10 @@
 #pragma once
 
 #include "DefaultAudioProcessor.h"
+#include "GainStageProcessor.h"
 #include "view/parameter_control/level_meter/LevelMeter.h"
 
-class TrackOutputProcessor : public DefaultAudioProcessor {
+class TrackOutputProcessor : public DefaultAudioProcessor, public GainStageProcessor {
 public:
     explicit TrackOutputProcessor() :
             DefaultAudioProcessor(getPluginDescription()),
@@ -45,30 +46,33 @@ public:
         }
     }
 
-    void processBlock(AudioSampleBuffer &buffer, MidiBuffer &midiMessages) override {
-        if (buffer.getNumChannels() == 2) {
-            // 0db at center, linear stereo balance control
-            // http://www.kvraudio.com/forum/viewtopic.php?t=148865
-            for (int i = 0; i < buffer.getNumSamples(); i++) {
-                const float balanceValue = balance.getNextValue();
-
-                float leftChannelGain, rightChannelGain;
-                if (balanceValue < 0.0) {
-                    leftChannelGain = 1;
-                    rightChannelGain = 1 + balanceValue;
-                } else {
-                    leftChannelGain = 1 - balanceValue;
-                    rightChannelGain = 1;
-                }
-
-                buffer.setSample(0, i, buffer.getSample(0, i) * leftChannelGain);
-                buffer.setSample(1, i, buffer.getSample(1, i) * rightChannelGain);
-            }
+    // While the track is frozen, its output is this (pre-balance & gain) audio, looped, instead of whatever comes in.
+    void setFrozenAudio(std::unique_ptr<AudioBuffer<float>> frozenAudio) {
+        {
+            const ScopedLock callbackLock(getCallbackLock());
+            std::swap(this->frozenAudio, frozenAudio);
+            frozenAudioPosition = 0;
         }
-        gain.applyGain(buffer, buffer.getNumSamples());
-        meterSource.measureBlock(buffer);
+        // The previous frozen audio is freed here, outside the audio callback.
+    }
+
+    bool isFrozen() const { return frozenAudio != nullptr; }
+
+    void processBlock(AudioSampleBuffer &buffer, MidiBuffer &midiMessages) override {
+        if (frozenAudio != nullptr)
+            readFrozenAudio(buffer, midiMessages);
+        processGainStage(buffer, midiMessages);
+    }
+
+    void accumulateGains(float *leftGains, float *rightGains, int numSamples, bool isStereo) override {
+        accumulateBalance(balance, leftGains, rightGains, numSamples, isStereo);
+        accumulateGain(gain, leftGains, rightGains, numSamples);
     }
 
+    // Frozen audio replaces the input, so it can't be a gain on it.
+    bool canFuse() const override { return !isFrozen(); }
+    LevelMeterSource *getStageMeterSource() override { return &meterSource; }
+
     LevelMeterSource *getMeterSource() override { return &meterSource; }
     AudioProcessorParameter *getMeteredParameter() override { return gainParameter; }
 
@@ -79,4 +83,23 @@ private:
     AudioParameterFloat *balanceParameter;
     AudioParameterFloat *gainParameter;
     LevelMeterSource meterSource;
+
+    std::unique_ptr<AudioBuffer<float>> frozenAudio;
+    int frozenAudioPosition{0};
+
+    void readFrozenAudio(AudioSampleBuffer &buffer, MidiBuffer &midiMessages) {
+        midiMessages.clear();
+        const int frozenLength = frozenAudio->getNumSamples();
+        for (int startSample = 0; startSample < buffer.getNumSamples();) {
+            const int numSamples = jmin(buffer.getNumSamples() - startSample, frozenLength - frozenAudioPosition);
+            for (int channel = 0; channel < buffer.getNumChannels(); channel++) {
+                if (channel < frozenAudio->getNumChannels())
+                    buffer.copyFrom(channel, startSample, *frozenAudio, channel, frozenAudioPosition, numSamples);
+                else
+                    buffer.clear(channel, startSample, numSamples);
+            }
+            startSample += numSamples;
+            frozenAudioPosition = (frozenAudioPosition + numSamples) % frozenLength;
+        }
+    }
 };
@@ -7,4 +7,18 @@ using pixel_t = uint16_t;
 
 static const int WIDTH = 960;
 static const int HEIGHT = 160;
+
+// Pixels are XORed with these (alternating, starting with the even one) before they're sent.
+static constexpr pixel_t XOR_MASK_EVEN = 0xf3e7;
+static constexpr pixel_t XOR_MASK_ODD = 0xffe7;
+
+/*!
+ * \return pixel_t value in push display format from a (native-endian 0xAARRGGBB) ARGB value
+ * The display uses 16 bit per pixels in a 5:6:5 format
+ *      MSB                           LSB
+ *      b b b b|b g g g|g g g r|r r r r
+ */
+inline pixel_t pixelFromArgb(uint32_t argb) {
+    return static_cast<pixel_t>(((argb << 8) & 0xF800) | ((argb >> 5) & 0x07E0) | ((argb >> 19) & 0x001F));
+}
 }
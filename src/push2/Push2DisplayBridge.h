@@ -1,8 +1,19 @@
 #pragma once
 
+#include <bitset>
+#include <functional>
 #include "Push2Display.h"
+#include "Push2Rasterizer.h"
 #include "Push2UsbCommunicator.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define FLOWGRID_PUSH2_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FLOWGRID_PUSH2_NEON 1
+#endif
+
 /*!
  *  Implements a bridge between juce::Graphics and push2 display format.
  */
@@ -11,21 +22,79 @@ public:
     static const int PUSH_2_VENDOR_ID = 0x2982;
     static const int PUSH_2_PRODUCT_ID = 0x1967;
 
-    Push2DisplayBridge() : image(Image::RGB, Push2Display::WIDTH, Push2Display::HEIGHT, false),
+    // A software ARGB image, so its pixel layout is the same (4-byte, native-endian 0xAARRGGBB) on every platform.
+    Push2DisplayBridge() : image(Image::ARGB, Push2Display::WIDTH, Push2Display::HEIGHT, false, SoftwareImageType()),
                            graphics(image), usbCommunicator(PUSH_2_VENDOR_ID, PUSH_2_PRODUCT_ID) {}
 
     juce::Graphics &getGraphics() { return graphics; }
 
+    // Send frames to `displaySink` (not owned) instead of the Push 2 itself, or to the Push 2 again if it's `nullptr`.
+    // The new sink's frames are all filled from scratch.
+    void setDisplaySink(Push2DisplaySink *displaySink) {
+        sink = displaySink != nullptr ? displaySink : &usbCommunicator;
+        for (auto &frameStaleLines : staleLines)
+            frameStaleLines.set();
+    }
+
+    bool isDisplayConnected() { return sink->isDisplayConnected(); }
+
     inline void writeFrameToDisplay() {
-        if (!usbCommunicator.isValid()) return;
+        writeFrameToDisplay(RectangleList<int>({0, 0, Push2Display::WIDTH, Push2Display::HEIGHT}));
+    }
+
+    // Only convert the lines touched by `dirtyRegion` (plus any lines the frame being filled missed out on since it was
+    // last filled), and publish the frame.
+    // `rasterize` draws whatever is drawn straight into the frame (rather than into the image) over the converted lines.
+    inline void writeFrameToDisplay(const RectangleList<int> &dirtyRegion, const std::function<void(Push2Rasterizer &)> &rasterize = {}) {
+        if (!sink->isDisplayConnected()) return;
+
+        for (const auto &rectangle : dirtyRegion)
+            for (int y = jmax(0, rectangle.getY()); y < jmin(Push2Display::HEIGHT, rectangle.getBottom()); y++)
+                for (auto &frameStaleLines : staleLines)
+                    frameStaleLines.set((size_t) y);
+
+        auto &linesToConvert = staleLines[sink->getBackFrameIndex()];
+        const Image::BitmapData bitmapData(image, Image::BitmapData::readOnly);
+        jassert(bitmapData.pixelFormat == Image::ARGB && bitmapData.pixelStride == 4);
+        for (int y = 0; y < Push2Display::HEIGHT; y++)
+            if (linesToConvert[(size_t) y])
+                convertLine(reinterpret_cast<const uint32 *>(bitmapData.getLinePointer(y)), sink->getLinePixels(y), Push2Display::WIDTH);
+        if (rasterize) {
+            rasterizer.setTarget(sink, linesToConvert);
+            rasterize(rasterizer);
+        }
+        linesToConvert.reset();
+        sink->publishFrame();
+    }
+
+    // Send the last frame again, as is.
+    inline void resendFrameToDisplay() {
+        if (sink->isDisplayConnected())
+            sink->resendFrame();
+    }
 
-        static const Push2Display::pixel_t xOrMasks[2] = {0xf3e7, 0xffe7};
-        for (int y = 0; y < Push2Display::HEIGHT; y++) {
-            for (int x = 0; x < Push2Display::WIDTH; x++) {
-                usbCommunicator.setPixelValue(x, y, pixelFromColour(image.getPixelAt(x, y)) ^ xOrMasks[x % 2]);
-            }
+    // Convert a line of ARGB pixels to (XOR-masked) display pixels, 8 at a time where SIMD is available.
+    static void convertLine(const uint32 *source, Push2Display::pixel_t *destination, int width) {
+        int x = 0;
+#if FLOWGRID_PUSH2_SSE2
+        const __m128i xOrMask = _mm_set1_epi32(static_cast<int>((uint32) Push2Display::XOR_MASK_ODD << 16 | Push2Display::XOR_MASK_EVEN));
+        for (; x + 8 <= width; x += 8) {
+            const __m128i pixels = _mm_packs_epi32(pixelsFromArgb(_mm_loadu_si128(reinterpret_cast<const __m128i *>(source + x))),
+                                                   pixelsFromArgb(_mm_loadu_si128(reinterpret_cast<const __m128i *>(source + x + 4))));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + x), _mm_xor_si128(pixels, xOrMask));
         }
-        usbCommunicator.onFrameFillCompleted();
+#elif FLOWGRID_PUSH2_NEON
+        static const uint16_t xOrMasks[8] = {Push2Display::XOR_MASK_EVEN, Push2Display::XOR_MASK_ODD, Push2Display::XOR_MASK_EVEN, Push2Display::XOR_MASK_ODD,
+                                             Push2Display::XOR_MASK_EVEN, Push2Display::XOR_MASK_ODD, Push2Display::XOR_MASK_EVEN, Push2Display::XOR_MASK_ODD};
+        const uint16x8_t xOrMask = vld1q_u16(xOrMasks);
+        for (; x + 8 <= width; x += 8) {
+            const uint16x8_t pixels = vcombine_u16(vmovn_u32(pixelsFromArgb(vld1q_u32(source + x))),
+                                                   vmovn_u32(pixelsFromArgb(vld1q_u32(source + x + 4))));
+            vst1q_u16(destination + x, veorq_u16(pixels, xOrMask));
+        }
+#endif
+        for (; x < width; x++)
+            destination[x] = static_cast<Push2Display::pixel_t>(Push2Display::pixelFromArgb(source[x]) ^ (x % 2 == 0 ? Push2Display::XOR_MASK_EVEN : Push2Display::XOR_MASK_ODD));
     }
 
     /*!
@@ -44,7 +113,28 @@ public:
     }
 
 private:
+#if FLOWGRID_PUSH2_SSE2
+    // Same as `Push2Display::pixelFromArgb`, for 4 pixels. The results are sign-extended, so that packing them (with signed saturation) is exact.
+    inline static __m128i pixelsFromArgb(__m128i argb) {
+        const __m128i pixels = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_slli_epi32(argb, 8), _mm_set1_epi32(0xF800)),
+                                                         _mm_and_si128(_mm_srli_epi32(argb, 5), _mm_set1_epi32(0x07E0))),
+                                            _mm_and_si128(_mm_srli_epi32(argb, 19), _mm_set1_epi32(0x001F)));
+        return _mm_srai_epi32(_mm_slli_epi32(pixels, 16), 16);
+    }
+#elif FLOWGRID_PUSH2_NEON
+    inline static uint32x4_t pixelsFromArgb(uint32x4_t argb) {
+        return vorrq_u32(vorrq_u32(vandq_u32(vshlq_n_u32(argb, 8), vdupq_n_u32(0xF800)),
+                                   vandq_u32(vshrq_n_u32(argb, 5), vdupq_n_u32(0x07E0))),
+                         vandq_u32(vshrq_n_u32(argb, 19), vdupq_n_u32(0x001F)));
+    }
+#endif
+
     juce::Image image;
+    // For each of the sink's frames, the lines that are behind the image.
+    std::bitset<Push2Display::HEIGHT> staleLines[Push2DisplaySink::NUM_FRAMES]{
+            std::bitset<Push2Display::HEIGHT>().set(), std::bitset<Push2Display::HEIGHT>().set(), std::bitset<Push2Display::HEIGHT>().set()};
     juce::Graphics graphics;
+    Push2Rasterizer rasterizer;
     Push2UsbCommunicator usbCommunicator;
+    Push2DisplaySink *sink{&usbCommunicator};
 };
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Push2Display.h"
+
+/*!
+ *  Where `Push2DisplayBridge` sends its frames of (XOR-masked) display pixels: the Push 2 itself, over usb,
+ *  or a stand-in for it.
+ *
+ *  There are `NUM_FRAMES` frames. The one being filled (the back frame) holds whatever was in it when it was last
+ *  published, so only the lines that changed since then need filling.
+ */
+class Push2DisplaySink {
+public:
+    static const int NUM_FRAMES = 3;
+
+    virtual ~Push2DisplaySink() = default;
+
+    virtual bool isDisplayConnected() = 0;
+
+    // Which of the `NUM_FRAMES` frames is being filled.
+    virtual int getBackFrameIndex() const = 0;
+
+    // The `Push2Display::WIDTH` pixels of line `y` of the frame being filled.
+    virtual Push2Display::pixel_t *getLinePixels(int y) = 0;
+
+    // Publish the filled frame as the latest complete one, to be displayed next.
+    virtual void publishFrame() = 0;
+
+    // Display the last published frame again, unchanged.
+    virtual void resendFrame() = 0;
+};
@@ -51,10 +51,19 @@ static bool isPadNoteNumber(int noteNumber) {
     return noteNumber >= P2::lowestPadNoteNumber && noteNumber <= P2::highestPadNoteNumber;
 }
 
-Push2MidiCommunicator::Push2MidiCommunicator(View &view, Push2Colours &push2Colours) : view(view), push2Colours(push2Colours) {}
+Push2MidiCommunicator::Push2MidiCommunicator(View &view, Push2Colours &push2Colours) : view(view), push2Colours(push2Colours) {
+    std::fill(std::begin(buttonLedValues), std::end(buttonLedValues), -1);
+    std::fill(std::begin(padLedValues), std::end(padLedValues), -1);
+    std::fill(std::begin(sentButtonLedValues), std::end(sentButtonLedValues), -1);
+    std::fill(std::begin(sentPadLedValues), std::end(sentPadLedValues), -1);
+    ledChanges.ensureSize(2 * 128 * 16 + 128 * 32);
+}
 
 void Push2MidiCommunicator::initialize() {
     MidiCommunicator::initialize();
+    // Whatever the Push 2 shows now, all LEDs that were set get sent again.
+    std::fill(std::begin(sentButtonLedValues), std::end(sentButtonLedValues), -1);
+    std::fill(std::begin(sentPadLedValues), std::end(sentPadLedValues), -1);
     push2Colours.addListener(this);
     registerAllIndexedColours();
 
@@ -74,6 +83,7 @@ void Push2MidiCommunicator::initialize() {
 }
 
 Push2MidiCommunicator::~Push2MidiCommunicator() {
+    cancelPendingUpdate();
     push2Colours.removeListener(this);
 }
 
@@ -84,39 +94,78 @@ void Push2MidiCommunicator::handleIncomingMidiMessage(MidiInput *source, const M
         MidiCommunicator::handleIncomingMidiMessage(source, message);
     }
 
-    MessageManager::callAsync([this, source, message]() {
-        if (push2Listener == nullptr) return;
-
-        if (message.isController()) {
-            const auto ccNumber = message.getControllerNumber();
-            if (isEncoderCcNumber(ccNumber)) {
-                float changeAmount = encoderCcMessageToRotationChange(message);
-                if (ccNumber == masterKnob) {
-                    return push2Listener->masterEncoderRotated(changeAmount / 2.0f);
-                }
-                if (isAboveScreenEncoderCcNumber(ccNumber)) {
-                    return push2Listener->encoderRotated(ccNumber - topKnob3, changeAmount / 2.0f);
-                }
-                return;
-            }
+    // The listener only handles short messages.
+    if (message.isSysEx() || message.getRawDataSize() > 3) return;
+
+    int start1, size1, start2, size2;
+    inputQueue.prepareToWrite(1, start1, size1, start2, size2);
+    // Drop the message if the message thread is this far behind, rather than block the MIDI thread.
+    if (size1 == 0) return;
+
+    auto &event = inputEvents[start1];
+    event.source = source;
+    event.numBytes = message.getRawDataSize();
+    std::memcpy(event.bytes, message.getRawData(), size_t(event.numBytes));
+    inputQueue.finishedWrite(1);
+    triggerAsyncUpdate();
+}
+
+void Push2MidiCommunicator::handleAsyncUpdate() {
+    int start1, size1, start2, size2;
+    inputQueue.prepareToRead(inputQueue.getNumReady(), start1, size1, start2, size2);
+    for (int i = start1; i < start1 + size1; i++)
+        handleInputEvent(inputEvents[i]);
+    for (int i = start2; i < start2 + size2; i++)
+        handleInputEvent(inputEvents[i]);
+    inputQueue.finishedRead(size1 + size2);
+    flushEncoderChanges();
+}
+
+void Push2MidiCommunicator::handleInputEvent(const InputEvent &event) {
+    if (push2Listener == nullptr) return;
+
+    const MidiMessage message(event.bytes, event.numBytes);
+    if (message.isController()) {
+        const auto ccNumber = message.getControllerNumber();
+        // A fast turn sends lots of small steps. They're summed up, and the listener gets them all as one change.
+        if (isEncoderCcNumber(ccNumber)) {
+            pendingEncoderChanges[ccNumber] += encoderCcMessageToRotationChange(message);
+            return;
+        }
 
-            if (isButtonPressControlMessage(message)) {
-                static const Array<int> repeatableButtonCcNumbers{undo, up, down, left, right};
-                if (repeatableButtonCcNumbers.contains(ccNumber)) {
-                    buttonHoldStopped();
-                    currentlyHeldRepeatableButtonCcNumber = ccNumber;
-                    startTimer(BUTTON_HOLD_WAIT_FOR_REPEAT_MS);
-                }
-                return handleButtonPressMidiCcNumber(ccNumber);
-            }
-            if (isButtonReleaseControlMessage(message)) {
+        // Keep encoder changes in order with everything else.
+        flushEncoderChanges();
+        if (isButtonPressControlMessage(message)) {
+            static const Array<int> repeatableButtonCcNumbers{undo, up, down, left, right};
+            if (repeatableButtonCcNumbers.contains(ccNumber)) {
                 buttonHoldStopped();
-                return handleButtonReleaseMidiCcNumber(ccNumber);
+                currentlyHeldRepeatableButtonCcNumber = ccNumber;
+                startTimer(BUTTON_HOLD_WAIT_FOR_REPEAT_MS);
             }
-        } else {
-            push2Listener->handleIncomingMidiMessage(source, message);
+            return handleButtonPressMidiCcNumber(ccNumber);
+        }
+        if (isButtonReleaseControlMessage(message)) {
+            buttonHoldStopped();
+            return handleButtonReleaseMidiCcNumber(ccNumber);
         }
-    });
+    } else {
+        flushEncoderChanges();
+        push2Listener->handleIncomingMidiMessage(event.source, message);
+    }
+}
+
+void Push2MidiCommunicator::flushEncoderChanges() {
+    for (int ccNumber = 0; ccNumber < 128; ccNumber++) {
+        const auto changeAmount = pendingEncoderChanges[ccNumber];
+        if (changeAmount == 0.0f) continue;
+
+        pendingEncoderChanges[ccNumber] = 0.0f;
+        if (push2Listener == nullptr) continue;
+        if (ccNumber == masterKnob)
+            push2Listener->masterEncoderRotated(changeAmount / 2.0f);
+        else if (isAboveScreenEncoderCcNumber(ccNumber))
+            push2Listener->encoderRotated(ccNumber - topKnob3, changeAmount / 2.0f);
+    }
 }
 
 static int directionForArrowButtonCcNumber(int ccNumber) {
@@ -194,16 +243,16 @@ void Push2MidiCommunicator::setBelowScreenButtonEnabled(int buttonIndex, bool en
     setColourButtonEnabled(bottomDisplayButton1 + buttonIndex, enabled);
 }
 
-void Push2MidiCommunicator::enableWhiteLedButton(int buttonCcNumber) const {
-    sendMessageChecked(MidiMessage::controllerEvent(NO_ANIMATION_LED_CHANNEL, buttonCcNumber, 14));
+void Push2MidiCommunicator::enableWhiteLedButton(int buttonCcNumber) {
+    buttonLedValues[buttonCcNumber & 0x7F] = 14;
 }
 
-void Push2MidiCommunicator::disableWhiteLedButton(int buttonCcNumber) const {
-    sendMessageChecked(MidiMessage::controllerEvent(NO_ANIMATION_LED_CHANNEL, buttonCcNumber, 0));
+void Push2MidiCommunicator::disableWhiteLedButton(int buttonCcNumber) {
+    buttonLedValues[buttonCcNumber & 0x7F] = 0;
 }
 
-void Push2MidiCommunicator::activateWhiteLedButton(int buttonCcNumber) const {
-    sendMessageChecked(MidiMessage::controllerEvent(NO_ANIMATION_LED_CHANNEL, buttonCcNumber, 127));
+void Push2MidiCommunicator::activateWhiteLedButton(int buttonCcNumber) {
+    buttonLedValues[buttonCcNumber & 0x7F] = 127;
 }
 
 void Push2MidiCommunicator::setColourButtonEnabled(int buttonCcNumber, bool enabled) {
@@ -214,37 +263,67 @@ void Push2MidiCommunicator::setColourButtonEnabled(int buttonCcNumber, bool enab
 }
 
 void Push2MidiCommunicator::setButtonColour(int buttonCcNumber, const Colour &colour) {
-    auto colourIndex = push2Colours.findIndexForColourAddingIfNeeded(colour);
-    sendMessageChecked(MidiMessage::controllerEvent(NO_ANIMATION_LED_CHANNEL, buttonCcNumber, colourIndex));
+    buttonLedValues[buttonCcNumber & 0x7F] = push2Colours.findIndexForColourAddingIfNeeded(colour);
 }
 
 void Push2MidiCommunicator::disablePad(int noteNumber) {
     if (!isPadNoteNumber(noteNumber)) return;
 
-    sendMessageChecked(MidiMessage::noteOn(NO_ANIMATION_LED_CHANNEL, noteNumber, uint8(0)));
+    padLedValues[noteNumber] = 0;
 }
 
 void Push2MidiCommunicator::setPadColour(int noteNumber, const Colour &colour) {
     if (!isPadNoteNumber(noteNumber)) return;
 
-    auto colourIndex = push2Colours.findIndexForColourAddingIfNeeded(colour);
-    sendMessageChecked(MidiMessage::noteOn(NO_ANIMATION_LED_CHANNEL, noteNumber, colourIndex));
+    padLedValues[noteNumber] = push2Colours.findIndexForColourAddingIfNeeded(colour);
+}
+
+void Push2MidiCommunicator::flushLedChanges() {
+    if (!isOutputConnected()) return;
+
+    ledChanges.clear();
+    // Palette entries go first, so the LEDs using them show the new colours, and the palette is reapplied only once.
+    if (pendingPaletteIndices.any()) {
+        for (int colourIndex = 0; colourIndex < 128; colourIndex++)
+            if (pendingPaletteIndices[size_t(colourIndex)])
+                addPaletteEntryMessage(ledChanges, uint8(colourIndex), pendingPaletteColours[colourIndex]);
+        pendingPaletteIndices.reset();
+        static const uint8 reapplyColorPaletteCommand[]{0x00, 0x21, 0x1D, 0x01, 0x01, 0x05};
+        ledChanges.addEvent(MidiMessage::createSysExMessage(reapplyColorPaletteCommand, 6), 0);
+    }
+    for (int i = 0; i < 128; i++) {
+        if (buttonLedValues[i] != -1 && buttonLedValues[i] != sentButtonLedValues[i]) {
+            ledChanges.addEvent(MidiMessage::controllerEvent(NO_ANIMATION_LED_CHANNEL, i, buttonLedValues[i]), 0);
+            sentButtonLedValues[i] = buttonLedValues[i];
+        }
+        if (padLedValues[i] != -1 && padLedValues[i] != sentPadLedValues[i]) {
+            ledChanges.addEvent(MidiMessage::noteOn(NO_ANIMATION_LED_CHANNEL, i, uint8(padLedValues[i])), 0);
+            sentPadLedValues[i] = padLedValues[i];
+        }
+    }
+    if (!ledChanges.isEmpty())
+        sendBlockOfMessagesNow(ledChanges);
 }
 
 void Push2MidiCommunicator::sendMessageChecked(const MidiMessage &message) const {
     if (isOutputConnected())
-        midiOutput->sendMessageNow(message);
+        sendMessageNow(message);
 }
 
 void Push2MidiCommunicator::registerAllIndexedColours() {
     for (auto &pair : push2Colours.indexForColour) {
-        colourAdded(Colour::fromString(pair.first), pair.second);
+        colourAdded(Colour(pair.first), pair.second);
     }
 }
 
 void Push2MidiCommunicator::colourAdded(const Colour &colour, uint8 colourIndex) {
     jassert(colourIndex > 0 && colourIndex < CHAR_MAX - 1);
 
+    pendingPaletteColours[colourIndex] = colour;
+    pendingPaletteIndices.set(colourIndex);
+}
+
+void Push2MidiCommunicator::addPaletteEntryMessage(MidiBuffer &messages, uint8 colourIndex, const Colour &colour) {
     uint32 argb = colour.getARGB();
     // 8 bytes: 2 for each of R, G, B, W. First byte contains the 7 LSBs; Second byte contains the 1 MSB.
     uint8 bgra[8];
@@ -257,10 +336,7 @@ void Push2MidiCommunicator::colourAdded(const Colour &colour, uint8 colourIndex)
 
     const uint8 setLedColourPaletteEntryCommand[]{0x00, 0x21, 0x1D, 0x01, 0x01, 0x03, colourIndex,
                                                   bgra[4], bgra[5], bgra[2], bgra[3], bgra[0], bgra[1], bgra[6], bgra[7]};
-    auto setLedColourPaletteEntryMessage = MidiMessage::createSysExMessage(setLedColourPaletteEntryCommand, 15);
-    sendMessageChecked(setLedColourPaletteEntryMessage);
-    static const uint8 reapplyColorPaletteCommand[]{0x00, 0x21, 0x1D, 0x01, 0x01, 0x05};
-    sendMessageChecked(MidiMessage::createSysExMessage(reapplyColorPaletteCommand, 6));
+    messages.addEvent(MidiMessage::createSysExMessage(setLedColourPaletteEntryCommand, 15), 0);
 }
 
 void Push2MidiCommunicator::buttonHoldStopped() {
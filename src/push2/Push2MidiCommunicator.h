@@ -1,10 +1,11 @@
 #pragma once
 
+#include <bitset>
 #include "midi/MidiCommunicator.h"
 #include "view/push2/Push2Listener.h"
 #include "view/push2/Push2Colours.h"
 
-class Push2MidiCommunicator : public MidiCommunicator, private Push2Colours::Listener, private Timer {
+class Push2MidiCommunicator : public MidiCommunicator, private Push2Colours::Listener, private Timer, private AsyncUpdater {
 public:
     static const uint8
             topKnob1 = 14, topKnob2 = 15, topKnob3 = 71, topKnob4 = 72, topKnob5 = 73, topKnob6 = 74, topKnob7 = 75,
@@ -43,15 +44,20 @@ public:
     void setBelowScreenButtonColour(int buttonIndex, const Colour &colour);
     void setAboveScreenButtonEnabled(int buttonIndex, bool enabled);
     void setBelowScreenButtonEnabled(int buttonIndex, bool enabled);
-    void enableWhiteLedButton(int buttonCcNumber) const;
-    void disableWhiteLedButton(int buttonCcNumber) const;
-    void activateWhiteLedButton(int buttonCcNumber) const;
+    // LED changes only update the LED state table. Call `flushLedChanges` to send the LEDs that changed.
+    void enableWhiteLedButton(int buttonCcNumber);
+    void disableWhiteLedButton(int buttonCcNumber);
+    void activateWhiteLedButton(int buttonCcNumber);
     void setColourButtonEnabled(int buttonCcNumber, bool enabled);
     void setButtonColour(int buttonCcNumber, const Colour &colour);
     void disablePad(int noteNumber);
     void setPadColour(int noteNumber, const Colour &colour);
     static uint8 ccNumberForArrowButton(int direction);
 
+    // Send every LED that was changed since the last flush (and ended up different from what the Push 2 shows),
+    // along with any new palette colours, in one batch.
+    void flushLedChanges();
+
 private:
     static constexpr int NO_ANIMATION_LED_CHANNEL = 1;
     static constexpr int BUTTON_HOLD_REPEAT_HZ = 10; // how often to repeat a repeatable button press when it is held
@@ -64,8 +70,34 @@ private:
     int currentlyHeldRepeatableButtonCcNumber{0};
     bool holdRepeatIsHappeningNow{false};
 
+    // Incoming (non-sysex) messages for the listener, queued by the MIDI thread and all handled at once on the message thread.
+    struct InputEvent {
+        MidiInput *source;
+        uint8 bytes[3];
+        int numBytes;
+    };
+    static constexpr int INPUT_QUEUE_SIZE = 512;
+    AbstractFifo inputQueue{INPUT_QUEUE_SIZE};
+    InputEvent inputEvents[INPUT_QUEUE_SIZE]{};
+    // Encoder movement summed up while handling queued events, by CC number.
+    float pendingEncoderChanges[128]{};
+
+    void handleAsyncUpdate() override;
+    void handleInputEvent(const InputEvent &event);
+    void flushEncoderChanges();
+
+    // The value (palette index or white LED brightness) each button and pad LED was last set to, or -1 if it never was,
+    // and the value last sent to the Push 2, or -1 if it doesn't have one.
+    int16 buttonLedValues[128], padLedValues[128];
+    int16 sentButtonLedValues[128], sentPadLedValues[128];
+    MidiBuffer ledChanges;
+    // Palette entries added or changed since the last flush.
+    Colour pendingPaletteColours[128];
+    std::bitset<128> pendingPaletteIndices;
+
     void sendMessageChecked(const MidiMessage &message) const;
     void registerAllIndexedColours();
+    static void addPaletteEntryMessage(MidiBuffer &messages, uint8 colourIndex, const Colour &colour);
 
     void colourAdded(const Colour &colour, uint8 colourIndex) override;
     void trackColourChanged(const String &trackUuid, const Colour &colour) override {}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <bitset>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "Push2DisplaySink.h"
+
+using namespace juce;
+
+/*!
+ *  Draws rectangles and single lines of text straight into a frame of display pixels (XOR-masked 5:6:5),
+ *  skipping `juce::Graphics` and the conversion pass for the simple, opaque things the Push 2 views are made of.
+ *
+ *  Text is drawn from a cache of antialiased glyphs, rendered once per font and character (and laid out without kerning).
+ */
+class Push2Rasterizer {
+public:
+    // Draw into the back frame of `displaySink`, only on the lines set in `linesToDraw`.
+    void setTarget(Push2DisplaySink *displaySink, const std::bitset<Push2Display::HEIGHT> &linesToDraw) {
+        sink = displaySink;
+        lines = linesToDraw;
+        clipBounds = displayBounds;
+    }
+
+    // Only draw within `area` (on the display), e.g. the part of a component its ancestors don't hide.
+    void setClip(Rectangle<int> area) { clipBounds = area.getIntersection(displayBounds); }
+
+    void fillRect(Rectangle<int> area, const Colour &colour) {
+        area = area.getIntersection(clipBounds);
+        if (area.isEmpty()) return;
+
+        const auto pixel = Push2Display::pixelFromArgb(opaque(colour).getARGB());
+        const Push2Display::pixel_t maskedPixels[2]{static_cast<Push2Display::pixel_t>(pixel ^ Push2Display::XOR_MASK_EVEN),
+                                                    static_cast<Push2Display::pixel_t>(pixel ^ Push2Display::XOR_MASK_ODD)};
+        for (int y = area.getY(); y < area.getBottom(); y++) {
+            if (!lines[(size_t) y]) continue;
+            auto *linePixels = sink->getLinePixels(y);
+            for (int x = area.getX(); x < area.getRight(); x++)
+                linePixels[x] = maskedPixels[x & 1];
+        }
+    }
+
+    // Draw a line of text over `background` (already drawn under it), justified within `area`.
+    // Characters that don't fit in the area are left out.
+    void drawText(const String &text, const Font &font, Rectangle<int> area, Justification justification,
+                  const Colour &textColour, const Colour &background) {
+        auto &glyphs = getGlyphs(font);
+        float textWidth = 0;
+        int numCharacters = 0;
+        for (auto character = text.getCharPointer(); !character.isEmpty(); numCharacters++) {
+            const auto advance = getGlyph(glyphs, font, character.getAndAdvance()).advance;
+            if (textWidth + advance > float(area.getWidth())) break;
+            textWidth += advance;
+        }
+        if (numCharacters == 0) return;
+
+        const auto textBounds = justification.appliedToRectangle(
+                Rectangle<int>(int(std::ceil(textWidth)), int(std::ceil(font.getHeight()))), area);
+        const auto textClipBounds = area.getIntersection(clipBounds);
+        if (textClipBounds.isEmpty()) return;
+
+        // Pixels for each glyph coverage level, blended over the background.
+        const auto backgroundColour = opaque(background), opaqueTextColour = textColour.withAlpha(1.0f);
+        for (int alpha = 0; alpha < 256; alpha++)
+            shades[alpha] = Push2Display::pixelFromArgb(
+                    backgroundColour.interpolatedWith(opaqueTextColour, textColour.getFloatAlpha() * float(alpha) / 255.0f).getARGB());
+
+        auto x = float(textBounds.getX());
+        auto character = text.getCharPointer();
+        for (int i = 0; i < numCharacters; i++) {
+            const auto &glyph = getGlyph(glyphs, font, character.getAndAdvance());
+            drawGlyph(glyph, roundToInt(x) - GLYPH_PADDING, textBounds.getY() - GLYPH_PADDING, textClipBounds);
+            x += glyph.advance;
+        }
+    }
+
+private:
+    // Room around each glyph's advance, for the parts that hang over.
+    static constexpr int GLYPH_PADDING = 2;
+
+    struct Glyph {
+        float advance;
+        int width, height;
+        std::vector<uint8> coverage;
+    };
+    using Glyphs = std::unordered_map<juce_wchar, Glyph>;
+
+    const Rectangle<int> displayBounds{Push2Display::WIDTH, Push2Display::HEIGHT};
+    Rectangle<int> clipBounds{displayBounds};
+    Push2DisplaySink *sink{};
+    std::bitset<Push2Display::HEIGHT> lines;
+    Push2Display::pixel_t shades[256]{};
+    // There are only ever a few fonts.
+    std::vector<std::pair<Font, std::unique_ptr<Glyphs>>> glyphsForFont;
+
+    static Colour opaque(const Colour &colour) { return Colours::black.overlaidWith(colour); }
+
+    Glyphs &getGlyphs(const Font &font) {
+        for (auto &[glyphsFont, glyphs] : glyphsForFont)
+            if (glyphsFont == font)
+                return *glyphs;
+        glyphsForFont.emplace_back(font, std::make_unique<Glyphs>());
+        return *glyphsForFont.back().second;
+    }
+
+    static const Glyph &getGlyph(Glyphs &glyphs, const Font &font, juce_wchar character) {
+        auto entry = glyphs.find(character);
+        if (entry == glyphs.end())
+            entry = glyphs.emplace(character, renderGlyph(font, character)).first;
+        return entry->second;
+    }
+
+    static Glyph renderGlyph(const Font &font, juce_wchar character) {
+        const auto text = String::charToString(character);
+        Glyph glyph;
+        glyph.advance = font.getStringWidthFloat(text);
+        glyph.width = int(std::ceil(glyph.advance)) + 2 * GLYPH_PADDING;
+        glyph.height = int(std::ceil(font.getHeight())) + 2 * GLYPH_PADDING;
+
+        Image image(Image::SingleChannel, glyph.width, glyph.height, true, SoftwareImageType());
+        {
+            Graphics g(image);
+            g.setFont(font);
+            g.setColour(Colours::white);
+            g.drawSingleLineText(text, GLYPH_PADDING, GLYPH_PADDING + roundToInt(font.getAscent()));
+        }
+        const Image::BitmapData bitmapData(image, Image::BitmapData::readOnly);
+        glyph.coverage.resize(size_t(glyph.width * glyph.height));
+        for (int y = 0; y < glyph.height; y++)
+            for (int x = 0; x < glyph.width; x++)
+                glyph.coverage[size_t(y * glyph.width + x)] = *bitmapData.getPixelPointer(x, y);
+        return glyph;
+    }
+
+    // Only where the glyph covers anything, since the background's already there.
+    void drawGlyph(const Glyph &glyph, int left, int top, const Rectangle<int> &clipBounds) {
+        const auto glyphBounds = Rectangle<int>(left, top, glyph.width, glyph.height).getIntersection(clipBounds);
+        for (int y = glyphBounds.getY(); y < glyphBounds.getBottom(); y++) {
+            if (!lines[(size_t) y]) continue;
+            auto *linePixels = sink->getLinePixels(y);
+            const auto *coverage = glyph.coverage.data() + (y - top) * glyph.width;
+            for (int x = glyphBounds.getX(); x < glyphBounds.getRight(); x++)
+                if (const auto alpha = coverage[x - left]; alpha != 0)
+                    linePixels[x] = static_cast<Push2Display::pixel_t>(shades[alpha] ^ (x % 2 == 0 ? Push2Display::XOR_MASK_EVEN : Push2Display::XOR_MASK_ODD));
+        }
+    }
+};
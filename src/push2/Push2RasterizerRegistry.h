@@ -0,0 +1,41 @@
+#pragma once
+
+#include <functional>
+#include <typeindex>
+#include <unordered_map>
+#include "Push2Rasterizer.h"
+
+/*!
+ *  How to draw (some of) a component straight into the display's pixels, rather than through `juce::Graphics`,
+ *  looked up by the component's (exact) type. The components themselves don't know about the Push 2.
+ */
+class Push2RasterizerRegistry {
+public:
+    struct Entry {
+        // The area `rasterize` draws, in the component's local coordinates. It must cover all of it with opaque pixels,
+        // since nothing gets painted under it.
+        std::function<RectangleList<int>(Component &)> getRasterizedArea;
+        // Draw the rasterized area, with the component's top-left corner at the given origin on the display.
+        std::function<void(Component &, Push2Rasterizer &, juce::Point<int>)> rasterize;
+    };
+
+    template<typename ComponentType>
+    void add(std::function<RectangleList<int>(ComponentType &)> getRasterizedArea,
+             std::function<void(ComponentType &, Push2Rasterizer &, juce::Point<int>)> rasterize) {
+        entries[std::type_index(typeid(ComponentType))] = {
+                [getRasterizedArea](Component &component) { return getRasterizedArea(static_cast<ComponentType &>(component)); },
+                [rasterize](Component &component, Push2Rasterizer &rasterizer, juce::Point<int> origin) {
+                    rasterize(static_cast<ComponentType &>(component), rasterizer, origin);
+                },
+        };
+    }
+
+    // `nullptr` if components of this type are only painted.
+    const Entry *find(Component &component) const {
+        const auto entry = entries.find(std::type_index(typeid(component)));
+        return entry != entries.end() ? &entry->second : nullptr;
+    }
+
+private:
+    std::unordered_map<std::type_index, Entry> entries;
+};
@@ -1,34 +1,75 @@
 #pragma once
 
-#include <thread>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
 #include "usb/UsbCommunicator.h"
-#include "Push2Display.h"
+#include "Push2DisplaySink.h"
 
 /*!
  *  This class manages the communication with the Push 2 display over usb.
  *
+ *  Frames are triple-buffered: the renderer fills the back frame and publishes it as the latest complete frame
+ *  (swapping it with the previous latest one through a single atomic), and the usb thread swaps in the latest
+ *  complete frame at the start of every frame it sends. Neither side ever waits for the other, and a frame is
+ *  never changed while it's being sent.
  */
-class Push2UsbCommunicator : public UsbCommunicator {
+class Push2UsbCommunicator : public UsbCommunicator, public Push2DisplaySink {
 public:
     Push2UsbCommunicator(const uint16_t vendorId, const uint16_t productId) :
             UsbCommunicator(vendorId, productId), currentLine(0) {}
 
-    inline void setPixelValue(int x, int y, Push2Display::pixel_t value) {
-        pixels[y * LINE_WIDTH + x] = value;
+    ~Push2UsbCommunicator() override { stop(); }
+
+    bool isDisplayConnected() override { return isValid(); }
+
+    inline int getBackFrameIndex() const override { return backFrame; }
+
+    inline Push2Display::pixel_t *getLinePixels(int y) override {
+        return frames[backFrame] + y * LINE_WIDTH;
     }
 
-    inline void onFrameFillCompleted() {
+    // Can be called from any (single) rendering thread.
+    inline void publishFrame() override {
+        backFrame = latestFrame.exchange(backFrame | NEW_FRAME_FLAG) & FRAME_INDEX_MASK;
+        requestFrame();
+    }
+
+    // The display blanks out without frames for too long.
+    inline void resendFrame() override { requestFrame(); }
+
+protected:
+    // Transfers only keep going until the end of the frame, and then wait for the next one to be requested.
+    inline void requestFrame() {
+        const std::lock_guard<std::mutex> lock(transferMutex);
         if (frameHeaderTransfer == nullptr || headerNeedsSending.load()) {
             startSending();
+            return;
         }
+
+        frameRequested = true;
+        auto transfersToResume = std::move(waitingTransfers);
+        waitingTransfers.clear();
+        for (auto *transfer : transfersToResume)
+            submitNextSlice(transfer);
     }
 
-protected:
     /*!
-     *  Initiate the send process
+     *  Initiate the send process (allocating the transfers the first time since the device was opened)
      */
     void startSending() override {
+        if (!isValid()) return;
+
         currentLine = 0;
+        frameRequested = true;
+        if (frameHeaderTransfer != nullptr) {
+            auto transfersToRestart = std::move(waitingTransfers);
+            waitingTransfers.clear();
+            for (auto *transfer : transfersToRestart)
+                submitNextSlice(transfer);
+            return;
+        }
 
         // transfer struct for the frame header
         static unsigned char frameHeader[16] = {
@@ -39,16 +80,16 @@ protected:
         };
 
         static const unsigned char push2BulkEPOut = 0x01;
-        frameHeaderTransfer = allocateAndPrepareTransferChunk(handle, this, frameHeader, sizeof(frameHeader), push2BulkEPOut);
+        frameHeaderTransfer = allocateAndPrepareTransferChunk(frameHeader, sizeof(frameHeader), push2BulkEPOut);
 
         for (int i = 0; i < SEND_BUFFER_COUNT; i++) {
             unsigned char *buffer = (sendBuffers + i * SEND_BUFFER_SIZE);
 
             // Allocates a transfer struct for the send buffers
-            auto *transfer = allocateAndPrepareTransferChunk(handle, this, buffer, SEND_BUFFER_SIZE, push2BulkEPOut);
+            auto *transfer = allocateAndPrepareTransferChunk(buffer, SEND_BUFFER_SIZE, push2BulkEPOut);
 
             // Start a request for this buffer
-            sendNextSlice(transfer);
+            submitNextSlice(transfer);
         }
     }
 
@@ -56,29 +97,38 @@ protected:
      *  Send the next slice of data using the provided transfer struct
      */
     void sendNextSlice(libusb_transfer *transfer) override {
+        const std::lock_guard<std::mutex> lock(transferMutex);
+        submitNextSlice(transfer);
+    }
+
+    // Only with `transferMutex` held. A transfer that can't be submitted waits, to be restarted by `startSending`.
+    void submitNextSlice(libusb_transfer *transfer) {
         // Start of a new frame, so send header first
         if (currentLine == 0) {
-            if (libusb_submit_transfer(frameHeaderTransfer) < 0) {
+            // Nothing new to send. Wait for the next frame.
+            if (!frameRequested) {
+                waitingTransfers.push_back(transfer);
+                return;
+            }
+            frameRequested = false;
+            if (latestFrame.load() & NEW_FRAME_FLAG)
+                frontFrame = latestFrame.exchange(frontFrame) & FRAME_INDEX_MASK;
+            if (!submitTransfer(frameHeaderTransfer)) {
                 std::cerr << "could not submit frame header transfer" << '\n';
                 headerNeedsSending.store(true);
+                waitingTransfers.push_back(transfer);
                 return;
             }
             headerNeedsSending.store(false);
         }
 
-        // Copy the next slice of the source data (represented by currentLine)
+        // Copy the next slice of the frame being sent (represented by currentLine)
         // to the transfer buffer
-        unsigned char *dst = transfer->buffer;
-
-        const unsigned char *src = (const unsigned char *) pixels + LINE_SIZE_BYTES * currentLine;
-        unsigned char *end = dst + SEND_BUFFER_SIZE;
-
-        while (dst < end) {
-            *dst++ = *src++;
-        }
+        std::memcpy(transfer->buffer, frames[frontFrame] + LINE_WIDTH * currentLine, SEND_BUFFER_SIZE);
 
-        if (libusb_submit_transfer(transfer) < 0) {
+        if (!submitTransfer(transfer)) {
             std::cerr << "could not submit display data transfer" << '\n';
+            waitingTransfers.push_back(transfer);
             return;
         }
 
@@ -93,11 +143,15 @@ protected:
 
     /*!
      *  Callback for when a full frame has been sent
-     *  Note that there's no real need of doing double buffering since the
-     *  display deals nicely with it already
      */
     void onFrameSendCompleted() override {}
 
+    void onDeviceClosed() override {
+        waitingTransfers.clear();
+        currentLine = 0;
+        frameRequested = false;
+    }
+
 private:
     static const int LINE_WIDTH = 1024;
     static const int NUM_LINES = Push2Display::HEIGHT;
@@ -119,8 +173,21 @@ private:
     static const int SEND_BUFFER_COUNT = 3;
     static const int SEND_BUFFER_SIZE = LINE_COUNT_PER_SEND_BUFFER * LINE_SIZE_BYTES; // buffer length in bytes
 
-    Push2Display::pixel_t pixels[Push2UsbCommunicator::LINE_WIDTH * Push2UsbCommunicator::NUM_LINES]{};
+    static const int FRAME_INDEX_MASK = 0x3;
+    static const int NEW_FRAME_FLAG = 0x4;
+
+    Push2Display::pixel_t frames[NUM_FRAMES][Push2UsbCommunicator::LINE_WIDTH * Push2UsbCommunicator::NUM_LINES]{};
+    // Only accessed by the rendering thread.
+    int backFrame{0};
+    // Index of the latest complete frame, flagged with `NEW_FRAME_FLAG` until the usb thread takes it.
+    std::atomic<int> latestFrame{1};
+    // Only accessed with `transferMutex` held.
+    int frontFrame{2};
     unsigned char sendBuffers[SEND_BUFFER_COUNT * SEND_BUFFER_SIZE]{};
     uint8_t currentLine;
+
+    // Only accessed with `transferMutex` held.
+    bool frameRequested{false};
+    std::vector<libusb_transfer *> waitingTransfers;
 };
 
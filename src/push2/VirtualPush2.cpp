@@ -0,0 +1,107 @@
+#include "VirtualPush2.h"
+
+VirtualPush2::VirtualPush2(Push2MidiCommunicator &push2MidiCommunicator, Push2Component &push2Component)
+        : push2MidiCommunicator(push2MidiCommunicator), push2Component(push2Component),
+          statsStartSeconds(Time::getMillisecondCounterHiRes() / 1000.0) {
+    push2Component.setDisplaySink(&display);
+    push2MidiCommunicator.setVirtualDevice([this](const MidiMessage &message) { handleMessageToDevice(message); });
+    push2Component.setVisible(true); // refreshes button lights
+}
+
+VirtualPush2::~VirtualPush2() {
+    stopTimer();
+    push2MidiCommunicator.setMidiInputAndOutput(nullptr, nullptr);
+    push2Component.setDisplaySink(nullptr);
+}
+
+MidiMessage VirtualPush2::encoderRotated(int ccNumber, int steps) {
+    // 7-bit two's complement, as the Push 2 sends it. It never sends more than 63 steps in one message.
+    steps = jlimit(-63, 63, steps);
+    return MidiMessage::controllerEvent(1, ccNumber, steps >= 0 ? steps : 128 + steps);
+}
+
+void VirtualPush2::send(const MidiMessage &message) {
+    push2MidiCommunicator.handleIncomingMidiMessage(nullptr, message);
+}
+
+void VirtualPush2::playScript(const MidiMessageSequence &scriptToPlay) {
+    script = scriptToPlay;
+    script.sort();
+    nextScriptEventIndex = 0;
+    scriptStartSeconds = Time::getMillisecondCounterHiRes() / 1000.0;
+    timerCallback();
+}
+
+MidiMessageSequence VirtualPush2::loadScript(const File &midiFile) {
+    MidiMessageSequence loadedScript;
+    FileInputStream stream(midiFile);
+    MidiFile file;
+    if (!stream.openedOk() || !file.readFrom(stream)) return loadedScript;
+
+    file.convertTimestampTicksToSeconds();
+    for (int i = 0; i < file.getNumTracks(); i++)
+        loadedScript.addSequence(*file.getTrack(i), 0);
+    return loadedScript;
+}
+
+VirtualPush2::Stats VirtualPush2::getStats() const {
+    return {Time::getMillisecondCounterHiRes() / 1000.0 - statsStartSeconds,
+            display.getNumFramesPublished(), display.getNumFramesResent(), numLedMessages, numSysExMessages};
+}
+
+void VirtualPush2::resetStats() {
+    display.resetFrameCounts();
+    numLedMessages = 0;
+    numSysExMessages = 0;
+    statsStartSeconds = Time::getMillisecondCounterHiRes() / 1000.0;
+}
+
+double VirtualPush2::measureFrameRenderingMs(int numFrames) {
+    const auto startMs = Time::getMillisecondCounterHiRes();
+    for (int i = 0; i < numFrames; i++) {
+        push2Component.repaint();
+        push2Component.drawFrame();
+    }
+    return numFrames > 0 ? (Time::getMillisecondCounterHiRes() - startMs) / numFrames : 0;
+}
+
+double VirtualPush2::measureFrameConversionMs(int numFrames) {
+    std::vector<uint32> argbLine(Push2Display::WIDTH);
+    Random random;
+    for (auto &argb : argbLine)
+        argb = uint32(random.nextInt()) | 0xff000000;
+    std::vector<Push2Display::pixel_t> displayLine(Push2Display::WIDTH);
+
+    const auto startMs = Time::getMillisecondCounterHiRes();
+    for (int i = 0; i < numFrames; i++)
+        for (int y = 0; y < Push2Display::HEIGHT; y++)
+            Push2DisplayBridge::convertLine(argbLine.data(), displayLine.data(), Push2Display::WIDTH);
+    return numFrames > 0 ? (Time::getMillisecondCounterHiRes() - startMs) / numFrames : 0;
+}
+
+void VirtualPush2::handleMessageToDevice(const MidiMessage &message) {
+    if (message.isSysEx()) {
+        numSysExMessages++;
+    } else if (message.isController()) {
+        buttonColourIndices[message.getControllerNumber()] = uint8(message.getControllerValue());
+        numLedMessages++;
+    } else if (message.isNoteOnOrOff()) {
+        padColourIndices[message.getNoteNumber()] = message.getVelocity();
+        numLedMessages++;
+    }
+}
+
+void VirtualPush2::timerCallback() {
+    const auto scriptSeconds = Time::getMillisecondCounterHiRes() / 1000.0 - scriptStartSeconds;
+    for (; isPlayingScript(); nextScriptEventIndex++) {
+        const auto &message = script.getEventPointer(nextScriptEventIndex)->message;
+        if (message.getTimeStamp() > scriptSeconds) break;
+        if (!message.isMetaEvent())
+            send(message);
+    }
+
+    if (!isPlayingScript())
+        stopTimer();
+    else if (!isTimerRunning())
+        startTimer(1);
+}
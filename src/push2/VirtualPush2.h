@@ -0,0 +1,76 @@
+#pragma once
+
+#include "view/push2/Push2Component.h"
+#include "VirtualPush2Display.h"
+
+/*!
+ *  A software Push 2, for running the Push 2 views without the hardware (e.g. headlessly in CI) and measuring them.
+ *
+ *  While it exists, `Push2Component` renders to its `VirtualPush2Display`, and `Push2MidiCommunicator` talks to it
+ *  instead of the Push 2's MIDI ports: it sends pad, encoder and button events the way the Push 2 does (right away,
+ *  or scripted in a `MidiMessageSequence`), and keeps the LED state the communicator sets.
+ */
+class VirtualPush2 : private Timer {
+public:
+    VirtualPush2(Push2MidiCommunicator &push2MidiCommunicator, Push2Component &push2Component);
+
+    ~VirtualPush2() override;
+
+    VirtualPush2Display &getDisplay() { return display; }
+
+    // Messages the Push 2 sends for its controls.
+    static MidiMessage buttonPressed(int ccNumber) { return MidiMessage::controllerEvent(1, ccNumber, 127); }
+    static MidiMessage buttonReleased(int ccNumber) { return MidiMessage::controllerEvent(1, ccNumber, 0); }
+    // Positive steps turn right, negative steps turn left. (A full turn is about 210 steps.)
+    static MidiMessage encoderRotated(int ccNumber, int steps);
+    static MidiMessage padPressed(int noteNumber, uint8 velocity = 100) { return MidiMessage::noteOn(1, noteNumber, velocity); }
+    static MidiMessage padReleased(int noteNumber) { return MidiMessage::noteOff(1, noteNumber); }
+
+    // Send a message from the Push 2's controls right away.
+    void send(const MidiMessage &message);
+
+    // Send the script's messages at their timestamps (in seconds from now), replacing any script still playing.
+    void playScript(const MidiMessageSequence &script);
+    // The messages of all tracks of a MIDI file, as a script.
+    static MidiMessageSequence loadScript(const File &midiFile);
+    bool isPlayingScript() const { return nextScriptEventIndex < script.getNumEvents(); }
+
+    // The palette index (0 for off) each button's and each pad's LED was last set to.
+    uint8 getButtonColourIndex(int ccNumber) const { return buttonColourIndices[ccNumber & 0x7F]; }
+    uint8 getPadColourIndex(int noteNumber) const { return padColourIndices[noteNumber & 0x7F]; }
+
+    struct Stats {
+        double seconds;
+        int numFramesPublished, numFramesResent, numLedMessages, numSysExMessages;
+
+        double getFramesPerSecond() const { return seconds > 0 ? numFramesPublished / seconds : 0; }
+        double getLedMessagesPerSecond() const { return seconds > 0 ? (numLedMessages + numSysExMessages) / seconds : 0; }
+    };
+
+    // Everything since the virtual Push 2 was connected, or since the last `resetStats`.
+    Stats getStats() const;
+    void resetStats();
+
+    // Repaint the whole display and render it `numFrames` times in a row, returning the average milliseconds per frame.
+    double measureFrameRenderingMs(int numFrames);
+    // The average milliseconds it takes to convert a full frame of pixels for the display.
+    static double measureFrameConversionMs(int numFrames);
+
+private:
+    Push2MidiCommunicator &push2MidiCommunicator;
+    Push2Component &push2Component;
+    VirtualPush2Display display;
+
+    uint8 buttonColourIndices[128]{}, padColourIndices[128]{};
+    int numLedMessages{0}, numSysExMessages{0};
+    double statsStartSeconds;
+
+    MidiMessageSequence script;
+    int nextScriptEventIndex{0};
+    double scriptStartSeconds{0};
+
+    // Messages from `Push2MidiCommunicator` to the Push 2.
+    void handleMessageToDevice(const MidiMessage &message);
+
+    void timerCallback() override;
+};
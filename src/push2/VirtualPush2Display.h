@@ -0,0 +1,91 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "Push2DisplaySink.h"
+
+using namespace juce;
+
+/*!
+ *  Stands in for the Push 2 display, keeping its frames in memory (and optionally saving each published one as a PNG),
+ *  so the Push 2 views can be rendered and checked without the hardware.
+ *
+ *  Frames are only ever filled and published from the message thread, so it just cycles through them.
+ */
+class VirtualPush2Display : public Push2DisplaySink {
+public:
+    bool isDisplayConnected() override { return true; }
+
+    int getBackFrameIndex() const override { return backFrame; }
+
+    Push2Display::pixel_t *getLinePixels(int y) override {
+        return frames[backFrame] + y * Push2Display::WIDTH;
+    }
+
+    void publishFrame() override {
+        latestFrame = backFrame;
+        backFrame = (backFrame + 1) % NUM_FRAMES;
+        numFramesPublished++;
+        if (captureDirectory != File())
+            saveLatestFrame(captureDirectory.getChildFile(String::formatted("frame_%06d.png", numFramesPublished)));
+    }
+
+    void resendFrame() override { numFramesResent++; }
+
+    // Save every published frame to `directory` from now on, numbered in publishing order. Stop if it's `File()`.
+    void setCaptureDirectory(const File &directory) {
+        captureDirectory = directory;
+        if (captureDirectory != File())
+            captureDirectory.createDirectory();
+    }
+
+    int getNumFramesPublished() const { return numFramesPublished; }
+    int getNumFramesResent() const { return numFramesResent; }
+
+    void resetFrameCounts() {
+        numFramesPublished = 0;
+        numFramesResent = 0;
+    }
+
+    // The latest published frame, as it would show up on the display (with its colours reduced to 5:6:5 bits).
+    Image getLatestFrameImage() const {
+        Image frameImage(Image::RGB, Push2Display::WIDTH, Push2Display::HEIGHT, false, SoftwareImageType());
+        Image::BitmapData bitmapData(frameImage, Image::BitmapData::writeOnly);
+        for (int y = 0; y < Push2Display::HEIGHT; y++) {
+            const auto *linePixels = frames[latestFrame] + y * Push2Display::WIDTH;
+            for (int x = 0; x < Push2Display::WIDTH; x++)
+                bitmapData.setPixelColour(x, y, colourFromPixel(linePixels[x], x));
+        }
+        return frameImage;
+    }
+
+    bool saveLatestFrame(const File &pngFile) const {
+        pngFile.deleteFile();
+        FileOutputStream stream(pngFile);
+        PNGImageFormat pngFormat;
+        return stream.openedOk() && pngFormat.writeImageToStream(getLatestFrameImage(), stream);
+    }
+
+    // The number of pixels that differ between two frame images, for catching rendering changes.
+    static int countDifferentPixels(const Image &frameImage, const Image &otherFrameImage) {
+        jassert(frameImage.getBounds() == otherFrameImage.getBounds());
+        int numDifferentPixels = 0;
+        for (int y = 0; y < frameImage.getHeight(); y++)
+            for (int x = 0; x < frameImage.getWidth(); x++)
+                if (frameImage.getPixelAt(x, y) != otherFrameImage.getPixelAt(x, y))
+                    numDifferentPixels++;
+        return numDifferentPixels;
+    }
+
+private:
+    // Undoes `Push2DisplayBridge::convertLine`.
+    static Colour colourFromPixel(Push2Display::pixel_t pixel, int x) {
+        pixel = static_cast<Push2Display::pixel_t>(pixel ^ (x % 2 == 0 ? Push2Display::XOR_MASK_EVEN : Push2Display::XOR_MASK_ODD));
+        const auto expand = [](int value, int numBits) { return uint8(value << (8 - numBits) | value >> (2 * numBits - 8)); };
+        return Colour(expand(pixel & 0x1F, 5), expand((pixel >> 5) & 0x3F, 6), expand(pixel >> 11, 5));
+    }
+
+    Push2Display::pixel_t frames[NUM_FRAMES][Push2Display::WIDTH * Push2Display::HEIGHT]{};
+    int backFrame{0}, latestFrame{NUM_FRAMES - 1};
+    int numFramesPublished{0}, numFramesResent{0};
+    File captureDirectory;
+};
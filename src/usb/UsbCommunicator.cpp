@@ -1,29 +1,62 @@
 #include "UsbCommunicator.h"
 
+#include <cstdio>
+#include <stdexcept>
+
 UsbCommunicator::UsbCommunicator(const uint16_t vendorId, const uint16_t productId) :
-    vendorId(vendorId), productId(productId), frameHeaderTransfer(nullptr), terminate(false) {
-    auto errorCode = libusb_init(nullptr);
+    vendorId(vendorId), productId(productId), frameHeaderTransfer(nullptr) {
+    auto errorCode = libusb_init(&context);
     if (errorCode < 0) throw std::runtime_error("Failed to initialize libusb");
 
-    startTimer(1000); // check back every second
+    if (libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) {
+        // Enumerating makes a device that's already connected arrive right away.
+        errorCode = libusb_hotplug_register_callback(context, static_cast<libusb_hotplug_event>(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+                                                     LIBUSB_HOTPLUG_ENUMERATE, vendorId, productId, LIBUSB_HOTPLUG_MATCH_ANY,
+                                                     onHotplugEvent, this, &hotplugCallbackHandle);
+        hasHotplug = errorCode == LIBUSB_SUCCESS;
+    }
+    if (!hasHotplug)
+        deviceArrived.store(true); // look for it right away
+
+    eventThread = std::thread(&UsbCommunicator::handleUsbEvents, this);
 }
 
 UsbCommunicator::~UsbCommunicator() {
-    terminate = true;
-    if (pollThread.joinable()) {
-        pollThread.join();
-    }
+    stop();
+    libusb_exit(context);
+}
+
+void UsbCommunicator::stop() {
+    if (!eventThread.joinable()) return;
+
+    terminate.store(true);
+    libusb_interrupt_event_handler(context);
+    eventThread.join();
+    if (hasHotplug)
+        libusb_hotplug_deregister_callback(context, hotplugCallbackHandle);
+}
+
+int UsbCommunicator::onHotplugEvent(libusb_context *, libusb_device *, libusb_hotplug_event event, void *userData) {
+    // Opening and closing happens on the event thread, after this event has been handled.
+    auto *communicator = static_cast<UsbCommunicator *>(userData);
+    if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED)
+        communicator->deviceArrived.store(true);
+    else if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT)
+        communicator->deviceLeft.store(true);
+    return 0; // stay registered
 }
 
 void UsbCommunicator::onTransferFinished(libusb_transfer *transfer) {
+    numTransfersInFlight--;
+
     if (transfer->status != LIBUSB_TRANSFER_COMPLETED) {
         switch (transfer->status) {
             case LIBUSB_TRANSFER_ERROR:printf("transfer failed\n");
                 break;
             case LIBUSB_TRANSFER_TIMED_OUT:printf("transfer timed out\n");
                 break;
-            case LIBUSB_TRANSFER_CANCELLED:printf("transfer was cancelled\n");
-                break;
+            case LIBUSB_TRANSFER_CANCELLED:
+                return; // only when closing the device
             case LIBUSB_TRANSFER_STALL:printf("endpoint stalled/control request not supported\n");
                 break;
             case LIBUSB_TRANSFER_NO_DEVICE:printf("device was disconnected\n");
@@ -35,51 +68,74 @@ void UsbCommunicator::onTransferFinished(libusb_transfer *transfer) {
             default:printf("snd transfer failed with status: %d\n", transfer->status);
                 break;
         }
-        terminate.store(true);
-        libusb_close(handle);
-        handle = nullptr;
+        // Close the device, and open it again if it's still there.
+        deviceLeft.store(true);
+        deviceArrived.store(true);
     } else if (transfer->length != transfer->actual_length) {
-        char errorMsg[256];
-        sprintf(errorMsg, "only transferred %d of %d bytes\n", transfer->actual_length, transfer->length);
-        throw std::runtime_error(errorMsg);
+        printf("only transferred %d of %d bytes\n", transfer->actual_length, transfer->length);
+        deviceLeft.store(true);
+        deviceArrived.store(true);
+    } else if (terminate.load()) {
+        return;
     } else if (transfer == frameHeaderTransfer) {
-        if (!terminate.load()) {
-            onFrameSendCompleted();
-        }
+        onFrameSendCompleted();
     } else {
-        if (!terminate.load()) {
-            sendNextSlice(transfer);
-        }
+        sendNextSlice(transfer);
     }
 }
 
-void UsbCommunicator::pollUsbForEvents() {
-    static struct timeval timeout_500ms = {0, 500000};
-    int terminate_main_loop = 0;
-    while (!terminate_main_loop && !terminate.load()) {
-        if (libusb_handle_events_timeout_completed(nullptr, &timeout_500ms, &terminate_main_loop) < 0) {
-            assert(false);
-        }
+void UsbCommunicator::handleUsbEvents() {
+    // Without hotplug events, check back for the device every second.
+    struct timeval checkInterval = {1, 0};
+    while (!terminate.load()) {
+        if (deviceLeft.exchange(false))
+            closeDevice();
+        if (deviceArrived.exchange(false) && handle.load() == nullptr)
+            openDevice();
+
+        // Returns after handling any event (including hotplug events and finished transfers), or when interrupted.
+        const auto errorCode = hasHotplug ? libusb_handle_events(context) : libusb_handle_events_timeout_completed(context, &checkInterval, nullptr);
+        if (errorCode < 0 && errorCode != LIBUSB_ERROR_INTERRUPTED)
+            std::cerr << "could not handle usb events, error: " << errorCode << '\n';
+        if (!hasHotplug && handle.load() == nullptr)
+            deviceArrived.store(true);
     }
+    closeDevice();
 }
 
-libusb_transfer *UsbCommunicator::allocateAndPrepareTransferChunk(libusb_device_handle *handle, UsbCommunicator *instance, unsigned char *buffer, int bufferSize, const unsigned char endpoint) {
+libusb_transfer *UsbCommunicator::allocateAndPrepareTransferChunk(unsigned char *buffer, int bufferSize, const unsigned char endpoint) {
     // Allocate a transfer structure
     auto transfer = libusb_alloc_transfer(0);
     if (!transfer) return nullptr;
 
-    libusb_fill_bulk_transfer(transfer, handle, endpoint, buffer, bufferSize,
-        onTransferFinishedStatic, instance, 1000);
+    libusb_fill_bulk_transfer(transfer, handle.load(), endpoint, buffer, bufferSize,
+        onTransferFinishedStatic, this, 1000);
+    transfers.push_back(transfer);
     return transfer;
 }
 
-bool UsbCommunicator::findDeviceHandleAndStartPolling() {
+bool UsbCommunicator::submitTransfer(libusb_transfer *transfer) {
+    if (closing || transfer == nullptr || handle.load() == nullptr) return false;
+
+    numTransfersInFlight++;
+    if (libusb_submit_transfer(transfer) < 0) {
+        numTransfersInFlight--;
+        return false;
+    }
+    return true;
+}
+
+void UsbCommunicator::openDevice() {
     libusb_device **devices;
-    auto count = libusb_get_device_list(nullptr, &devices);
-    if (count < 0) throw std::runtime_error("could not get usb device list");
+    auto count = libusb_get_device_list(context, &devices);
+    if (count < 0) {
+        std::cerr << "could not get usb device list, error: " << count << '\n';
+        return;
+    }
 
     // Look for the one matching Push 2's descriptors
     libusb_device *device;
+    libusb_device_handle *deviceHandle = nullptr;
     int errorCode;
     for (int i = 0; (device = devices[i]) != nullptr; i++) {
         struct libusb_device_descriptor descriptor{};
@@ -91,12 +147,12 @@ bool UsbCommunicator::findDeviceHandleAndStartPolling() {
         if (descriptor.bDeviceClass == LIBUSB_CLASS_PER_INTERFACE
             && descriptor.idVendor == vendorId
             && descriptor.idProduct == productId) {
-            if ((errorCode = libusb_open(device, &handle)) < 0) {
+            if ((errorCode = libusb_open(device, &deviceHandle)) < 0) {
                 std::cerr << "could not open device, error: " << errorCode << '\n';
-            } else if ((errorCode = libusb_claim_interface(handle, 0)) < 0) {
+            } else if ((errorCode = libusb_claim_interface(deviceHandle, 0)) < 0) {
                 std::cerr << "could not claim device with interface 0, error: " << errorCode << '\n';
-                libusb_close(handle);
-                handle = nullptr;
+                libusb_close(deviceHandle);
+                deviceHandle = nullptr;
             } else {
                 break; // successfully opened
             }
@@ -105,19 +161,41 @@ bool UsbCommunicator::findDeviceHandleAndStartPolling() {
 
     libusb_free_device_list(devices, 1);
 
-    if (handle != nullptr) {
-        if (pollThread.joinable()) {
-            pollThread.join();
-            headerNeedsSending.store(true);
-            terminate.store(false);
-        }
-        pollThread = std::thread(&UsbCommunicator::pollUsbForEvents, this);
-        return true;
+    if (deviceHandle != nullptr) {
+        const std::lock_guard<std::mutex> lock(transferMutex);
+        headerNeedsSending.store(true);
+        handle.store(deviceHandle);
     }
-
-    return false;
 }
 
-void UsbCommunicator::timerCallback() {
-    if (handle == nullptr) findDeviceHandleAndStartPolling();
+void UsbCommunicator::closeDevice() {
+    if (handle.load() == nullptr) return;
+
+    {
+        const std::lock_guard<std::mutex> lock(transferMutex);
+        closing = true;
+        for (auto *transfer : transfers)
+            libusb_cancel_transfer(transfer);
+    }
+
+    // Let every transfer still in flight finish (this is the thread handling events) before freeing them.
+    struct timeval waitInterval = {0, 100000};
+    while (numTransfersInFlight.load() > 0)
+        if (libusb_handle_events_timeout_completed(context, &waitInterval, nullptr) < 0)
+            break;
+
+    const std::lock_guard<std::mutex> lock(transferMutex);
+    onDeviceClosed();
+    frameHeaderTransfer = nullptr;
+    // If any are somehow still in flight, leak them rather than free them from under libusb.
+    if (numTransfersInFlight.load() == 0)
+        for (auto *transfer : transfers)
+            libusb_free_transfer(transfer);
+    transfers.clear();
+    headerNeedsSending.store(true);
+
+    auto *deviceHandle = handle.exchange(nullptr);
+    libusb_release_interface(deviceHandle, 0);
+    libusb_close(deviceHandle);
+    closing = false;
 }
@@ -1,19 +1,27 @@
 #pragma once
 
 #include <atomic>
+#include <iostream>
+#include <mutex>
 #include <thread>
-
-#include <juce_events/juce_events.h>
+#include <vector>
 
 #include "libusb.h"
 
-class UsbCommunicator : private juce::Timer {
+/*!
+ *  Finds, opens and talks to a usb device, all on its own event thread, so (re)connecting never holds up the UI.
+ *
+ *  The device is found through libusb hotplug events where the platform has them, and by checking back every second
+ *  where it doesn't. When it goes away (or a transfer fails), all transfers still in flight are cancelled and waited
+ *  for before the device is closed, so none are left dangling.
+ */
+class UsbCommunicator {
 public:
     UsbCommunicator(uint16_t vendorId, uint16_t productId);
 
-    ~UsbCommunicator() override;
+    virtual ~UsbCommunicator();
 
-    bool isValid() { return handle != nullptr; }
+    bool isValid() { return handle.load() != nullptr; }
 
     /*!
      *  Callback for when a transfer is finished and the next one needs to be
@@ -22,16 +30,21 @@ public:
     void LIBUSB_CALL onTransferFinished(libusb_transfer *transfer);
 
     /*!
-     *  Continuously poll events from libusb, possibly treating any error reported
+     *  Handle libusb events (transfers and hotplug) until stopped, opening and closing the device as needed
      */
-    void pollUsbForEvents();
+    void handleUsbEvents();
 
 protected:
-    // Allocate a libusb_transfer mapped to a transfer buffer. It also sets
-    // up the callback needed to communicate the transfer is done
-    static libusb_transfer *allocateAndPrepareTransferChunk(libusb_device_handle *handle, UsbCommunicator *instance,
-                                                            unsigned char *buffer, int bufferSize, unsigned char endpoint);
+    // Allocate a libusb_transfer mapped to a transfer buffer. It also sets up the callback needed to communicate
+    // the transfer is done. It's freed when the device is closed.
+    // Only with `transferMutex` held.
+    libusb_transfer *allocateAndPrepareTransferChunk(unsigned char *buffer, int bufferSize, unsigned char endpoint);
+
+    // Submit a transfer allocated by `allocateAndPrepareTransferChunk`, unless the device is going away.
+    // Only with `transferMutex` held.
+    bool submitTransfer(libusb_transfer *transfer);
 
+    // Only with `transferMutex` held.
     virtual void startSending() = 0;
     virtual void sendNextSlice(libusb_transfer *transfer) = 0;
 
@@ -41,23 +54,45 @@ protected:
      */
     virtual void onFrameSendCompleted() = 0;
 
+    // Forget about all transfers, which are about to be freed. Called with `transferMutex` held.
+    virtual void onDeviceClosed() {}
+
+    // Close the device and stop the event thread. Subclasses call this in their destructor, since transfer callbacks
+    // call back into them.
+    void stop();
+
     uint16_t vendorId;
     uint16_t productId;
     libusb_transfer *frameHeaderTransfer;
-    libusb_device_handle *handle{};
     std::atomic<bool> headerNeedsSending{true};
 
-private:
-    void timerCallback() override;
-
-    bool findDeviceHandleAndStartPolling();
+    // Guards the device handle and all transfer submissions.
+    std::mutex transferMutex;
 
+private:
     // Callback received whenever a transfer has been completed.
     // We defer the processing to the communicator class
     LIBUSB_CALL static inline void onTransferFinishedStatic(libusb_transfer *transfer) {
         static_cast<UsbCommunicator *>(transfer->user_data)->onTransferFinished(transfer);
     }
 
-    std::thread pollThread;
-    std::atomic<bool> terminate;
+    LIBUSB_CALL static int onHotplugEvent(libusb_context *, libusb_device *, libusb_hotplug_event event, void *userData);
+
+    void openDevice();
+    void closeDevice();
+
+    libusb_context *context{};
+    libusb_hotplug_callback_handle hotplugCallbackHandle{};
+    bool hasHotplug{false};
+
+    std::atomic<libusb_device_handle *> handle{nullptr};
+    std::vector<libusb_transfer *> transfers;
+    std::atomic<int> numTransfersInFlight{0};
+    // Set when the device (probably) came or went, for the event thread to open or close it.
+    std::atomic<bool> deviceArrived{false}, deviceLeft{false};
+    // No new transfers are submitted while the device is being closed.
+    bool closing{false};
+
+    std::thread eventThread;
+    std::atomic<bool> terminate{false};
 };
@@ -2,6 +2,7 @@
 
 #include "view/CustomColourIds.h"
 #include "ApplicationPropertiesAndCommandManager.h"
+#include "processors/OutOfProcessPluginInstance.h"
 
 GraphEditorPanel::GraphEditorPanel(View &view, Tracks &tracks, Connections &connections, Input &input, Output &output, ProcessorGraph &processorGraph, Project &project, PluginManager &pluginManager)
     : view(view), tracks(tracks), connections(connections),
@@ -192,7 +193,7 @@ juce::Point<int> GraphEditorPanel::trackAndSlotAt(const MouseEvent &e) {
 
 static constexpr int
     DELETE_MENU_ID = 1, TOGGLE_BYPASS_MENU_ID = 2, ENABLE_DEFAULTS_MENU_ID = 3, DISCONNECT_ALL_MENU_ID = 4,
-    DISABLE_DEFAULTS_MENU_ID = 5, DISCONNECT_CUSTOM_MENU_ID = 6,
+    DISABLE_DEFAULTS_MENU_ID = 5, DISCONNECT_CUSTOM_MENU_ID = 6, HOST_OUT_OF_PROCESS_MENU_ID = 7, RESTART_PLUGIN_PROCESS_MENU_ID = 8,
     SHOW_PLUGIN_GUI_MENU_ID = 10, SHOW_ALL_PROGRAMS_MENU_ID = 11, CONFIGURE_AUDIO_MIDI_MENU_ID = 12;
 
 void GraphEditorPanel::showPopupMenu(const Track *track, int slot) {
@@ -226,6 +227,14 @@ void GraphEditorPanel::showPopupMenu(const Track *track, int slot) {
             menu.addItem(SHOW_ALL_PROGRAMS_MENU_ID, "Show all programs");
         }
 
+        const auto description = pluginManager.getDescriptionForIdentifier(processor->getId());
+        if (OutOfProcessPluginIPC::isSupported && description != nullptr && !InternalPluginFormat::isInternalPlugin(*description)) {
+            menu.addSeparator();
+            menu.addItem(HOST_OUT_OF_PROCESS_MENU_ID, "Run new instances in a separate process", true, pluginManager.shouldHostOutOfProcess(*description));
+            if (dynamic_cast<OutOfProcessPluginInstance *>(graph.getProcessorWrappers().getAudioProcessorForProcessor(processor)) != nullptr)
+                menu.addItem(RESTART_PLUGIN_PROCESS_MENU_ID, "Restart plugin process");
+        }
+
         menu.showMenuAsync({}, ModalCallbackFunction::create
             ([this, processor, slot, &pluginManager](int result) {
                 const auto &description = pluginManager.getChosenType(result);
@@ -253,6 +262,14 @@ void GraphEditorPanel::showPopupMenu(const Track *track, int slot) {
                         break;
                     case CONFIGURE_AUDIO_MIDI_MENU_ID:getCommandManager().invokeDirectly(CommandIDs::showAudioMidiSettings, false);
                         break;
+                    case HOST_OUT_OF_PROCESS_MENU_ID:
+                        if (auto processorDescription = pluginManager.getDescriptionForIdentifier(processor->getId()))
+                            pluginManager.setHostOutOfProcess(*processorDescription, !pluginManager.shouldHostOutOfProcess(*processorDescription));
+                        break;
+                    case RESTART_PLUGIN_PROCESS_MENU_ID:
+                        if (auto *outOfProcessPlugin = dynamic_cast<OutOfProcessPluginInstance *>(graph.getProcessorWrappers().getAudioProcessorForProcessor(processor)))
+                            outOfProcessPlugin->restart();
+                        break;
                     default:break;
                 }
             }));
@@ -3,9 +3,10 @@
 #include "view/graph_editor/processor/LabelGraphEditorProcessor.h"
 #include "view/graph_editor/processor/ParameterPanelGraphEditorProcessor.h"
 
-GraphEditorProcessorLane::GraphEditorProcessorLane(ProcessorLane *lane, Track *track, View &view, StatefulAudioProcessorWrappers &processorWrappers, ConnectorDragListener &connectorDragListener)
-        : lane(lane), track(track), view(view), processorWrappers(processorWrappers), connectorDragListener(connectorDragListener) {
+GraphEditorProcessorLane::GraphEditorProcessorLane(ProcessorLane *lane, Track *track, View &view, DragPreview &dragPreview, StatefulAudioProcessorWrappers &processorWrappers, ConnectorDragListener &connectorDragListener)
+        : lane(lane), track(track), view(view), dragPreview(dragPreview), processorWrappers(processorWrappers), connectorDragListener(connectorDragListener) {
     view.addStateListener(this);
+    dragPreview.addChangeListener(this);
     lane->addChildListener(this);
     // TODO shouldn't need to do this
     valueTreePropertyChanged(view.getState(), track->isMaster() ? ViewIDs::numMasterProcessorSlots : ViewIDs::numProcessorSlots);
@@ -15,6 +16,7 @@ GraphEditorProcessorLane::GraphEditorProcessorLane(ProcessorLane *lane, Track *t
 
 GraphEditorProcessorLane::~GraphEditorProcessorLane() {
     lane->removeChildListener(this);
+    dragPreview.removeChangeListener(this);
     view.removeStateListener(this);
 }
 
@@ -68,6 +70,8 @@ void GraphEditorProcessorLane::updateProcessorSlotColours() {
             fillColour = fillColour.brighter(0.2f);
         if (track->isSlotSelected(slot))
             fillColour = track->getColour();
+        if (dragPreview.isMoveTarget({track->getIndex(), slot}))
+            fillColour = fillColour.interpolatedWith(Colours::white, 0.5f);
         auto focusedTrackAndSlot = view.getFocusedTrackAndSlot();
         if (track->getIndex() == focusedTrackAndSlot.x && slot == focusedTrackAndSlot.y)
             fillColour = fillColour.brighter(0.16f);
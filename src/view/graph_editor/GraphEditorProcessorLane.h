@@ -1,13 +1,14 @@
 #pragma once
 
 #include "model/StatefulList.h"
+#include "model/DragPreview.h"
 #include "GraphEditorProcessorContainer.h"
 #include "ConnectorDragListener.h"
 #include "GraphEditorChannel.h"
 
-class GraphEditorProcessorLane : public Component, GraphEditorProcessorContainer, public ProcessorLane::Listener, public ValueTree::Listener {
+class GraphEditorProcessorLane : public Component, GraphEditorProcessorContainer, public ProcessorLane::Listener, public ValueTree::Listener, private ChangeListener {
 public:
-    explicit GraphEditorProcessorLane(ProcessorLane *lane, Track *track, View &view, StatefulAudioProcessorWrappers &processorWrappers, ConnectorDragListener &connectorDragListener);
+    explicit GraphEditorProcessorLane(ProcessorLane *lane, Track *track, View &view, DragPreview &dragPreview, StatefulAudioProcessorWrappers &processorWrappers, ConnectorDragListener &connectorDragListener);
 
     ~GraphEditorProcessorLane() override;
 
@@ -68,6 +69,7 @@ private:
     ProcessorLane *lane;
     Track *track;
     View &view;
+    DragPreview &dragPreview;
     StatefulAudioProcessorWrappers &processorWrappers;
     ConnectorDragListener &connectorDragListener;
 
@@ -82,4 +84,6 @@ private:
     }
 
     void valueTreePropertyChanged(ValueTree &tree, const Identifier &i) override;
+    // The drag preview changed.
+    void changeListenerCallback(ChangeBroadcaster *) override { updateProcessorSlotColours(); }
 };
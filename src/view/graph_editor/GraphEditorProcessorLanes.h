@@ -7,8 +7,8 @@ class GraphEditorProcessorLanes : public Component,
                                   public GraphEditorProcessorContainer,
                                   private ProcessorLanes::Listener {
 public:
-    explicit GraphEditorProcessorLanes(ProcessorLanes &lanes, Track *track, View &view, StatefulAudioProcessorWrappers &processorWrappers, ConnectorDragListener &connectorDragListener)
-            : lanes(lanes), track(track), view(view), processorWrappers(processorWrappers), connectorDragListener(connectorDragListener) {
+    explicit GraphEditorProcessorLanes(ProcessorLanes &lanes, Track *track, View &view, DragPreview &dragPreview, StatefulAudioProcessorWrappers &processorWrappers, ConnectorDragListener &connectorDragListener)
+            : lanes(lanes), track(track), view(view), dragPreview(dragPreview), processorWrappers(processorWrappers), connectorDragListener(connectorDragListener) {
         lanes.addChildListener(this);
     }
 
@@ -17,7 +17,7 @@ public:
     }
 
     void onChildAdded(ProcessorLane *lane) override {
-        addAndMakeVisible(children.insert(lane->getIndex(), new GraphEditorProcessorLane(lane, track, view, processorWrappers, connectorDragListener)));
+        addAndMakeVisible(children.insert(lane->getIndex(), new GraphEditorProcessorLane(lane, track, view, dragPreview, processorWrappers, connectorDragListener)));
         resized();
     }
     void onChildRemoved(ProcessorLane *lane, int oldIndex) override {
@@ -60,6 +60,7 @@ private:
     ProcessorLanes &lanes;
     Track *track;
     View &view;
+    DragPreview &dragPreview;
     StatefulAudioProcessorWrappers &processorWrappers;
     ConnectorDragListener &connectorDragListener;
 };
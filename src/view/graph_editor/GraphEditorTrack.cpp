@@ -3,7 +3,7 @@
 GraphEditorTrack::GraphEditorTrack(Track *track, View &view, Project &project, StatefulAudioProcessorWrappers &processorWrappers, PluginManager &pluginManager,
                                    ConnectorDragListener &connectorDragListener)
     : track(track), view(view), project(project), processorWrappers(processorWrappers), connectorDragListener(connectorDragListener),
-      lanes(track->getProcessorLanes(), track, view, processorWrappers, connectorDragListener) {
+      lanes(track->getProcessorLanes(), track, view, project.getDragPreview(), processorWrappers, connectorDragListener) {
     addAndMakeVisible(lanes);
 
     track->addTrackListener(this);
@@ -46,6 +46,8 @@ protected:
     LevelMeter::Orientation orientation;
     ShapeButton thumb;
 
+    const LevelMeterSource *getMeterSource() const { return source.get(); }
+
     float getValueForPosition(juce::Point<int> localPosition) const override {
         return orientation == vertical ?
                std::clamp(1.0f - float(localPosition.y) / float(getHeight()), 0.0f, 1.0f) :
@@ -27,7 +27,8 @@ Rectangle<int> MinimalLevelMeter::getMeterBounds() {
            r.reduced(THUMB_WIDTH, getHeight() / 10);
 }
 
-void MinimalLevelMeter::drawMeterBars(Graphics &g, const LevelMeterSource *source) {
+template<typename DrawBar>
+void MinimalLevelMeter::forEachMeterBar(const LevelMeterSource *source, DrawBar drawBar) {
     const int numChannels = source ? static_cast<const int>(source->getNumChannels()) : 1;
     auto meterBounds = getMeterBounds();
     const int shortDimension = orientation == vertical ? meterBounds.getWidth() : meterBounds.getHeight();
@@ -36,8 +37,6 @@ void MinimalLevelMeter::drawMeterBars(Graphics &g, const LevelMeterSource *sourc
         const auto &meterBarBounds = orientation == vertical ?
                                      meterBounds.removeFromLeft(meterWidth).reduced(shortDimension / 10, 0.0f) :
                                      meterBounds.removeFromTop(meterWidth).reduced(0.0f, shortDimension / 10);
-        g.setColour(findColour(backgroundColourId));
-        g.fillRect(meterBarBounds);
         if (source != nullptr) {
             const static float infinity = -80.0f;
             float rmsLevel = source->getRMSLevel(static_cast<unsigned int>(channel));
@@ -50,8 +49,24 @@ void MinimalLevelMeter::drawMeterBars(Graphics &g, const LevelMeterSource *sourc
             const auto &fillBounds = orientation == vertical ?
                                      meterBarBounds.withHeight(static_cast<int>(rmsDbScaled * static_cast<float>(meterBarBounds.getHeight()))) :
                                      meterBarBounds.withWidth(static_cast<int>(rmsDbScaled * static_cast<float>(meterBarBounds.getWidth())));
+            drawBar(meterBarBounds, fillBounds);
+        } else {
+            drawBar(meterBarBounds, Rectangle<int>());
+        }
+    }
+}
+
+void MinimalLevelMeter::drawMeterBars(Graphics &g, const LevelMeterSource *source) {
+    forEachMeterBar(source, [this, &g](const Rectangle<int> &barBounds, const Rectangle<int> &fillBounds) {
+        g.setColour(findColour(backgroundColourId));
+        g.fillRect(barBounds);
+        if (!fillBounds.isEmpty()) {
             g.setColour(findColour(foregroundColourId));
             g.fillRect(fillBounds);
         }
-    }
+    });
+}
+
+void MinimalLevelMeter::forEachMeterBar(const std::function<void(const Rectangle<int> &, const Rectangle<int> &)> &drawBar) {
+    forEachMeterBar(getMeterSource(), drawBar);
 }
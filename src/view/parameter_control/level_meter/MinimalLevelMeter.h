@@ -9,10 +9,17 @@ public:
 
     void resized() override;
 
+    // Calls `drawBar(barBounds, fillBounds)` with each channel's bar, as `paint` draws it, in local coordinates.
+    void forEachMeterBar(const std::function<void(const Rectangle<int> &barBounds, const Rectangle<int> &fillBounds)> &drawBar);
+
 private:
     static constexpr int THUMB_WIDTH = 4;
 
     Rectangle<int> getMeterBounds();
 
+    // Calls `drawBar(barBounds, fillBounds)` for each channel's bar. (The fill is empty without a source.)
+    template<typename DrawBar>
+    void forEachMeterBar(const LevelMeterSource *source, DrawBar drawBar);
+
     void drawMeterBars(Graphics &g, const LevelMeterSource *source) override;
 };
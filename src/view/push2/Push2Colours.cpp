@@ -12,10 +12,11 @@ Push2Colours::~Push2Colours() {
 }
 
 uint8 Push2Colours::findIndexForColourAddingIfNeeded(const Colour &colour) {
-    auto entry = indexForColour.find(colour.toString());
+    const auto argb = colour.getARGB();
+    auto entry = indexForColour.find(argb);
     if (entry == indexForColour.end()) {
         addColour(colour);
-        entry = indexForColour.find(colour.toString());
+        entry = indexForColour.find(argb);
     }
     jassert(entry != indexForColour.end());
     return entry->second;
@@ -28,7 +29,7 @@ void Push2Colours::addColour(const Colour &colour) {
 
 void Push2Colours::setColour(uint8 colourIndex, const Colour &colour) {
     jassert(colourIndex > 0 && colourIndex < CHAR_MAX - 1);
-    indexForColour[colour.toString()] = colourIndex;
+    indexForColour[colour.getARGB()] = colourIndex;
     listeners.call(&Listener::colourAdded, colour, colourIndex);
 }
 
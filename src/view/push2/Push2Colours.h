@@ -22,7 +22,8 @@ public:
     void addListener(Listener *listener) { listeners.add(listener); }
     void removeListener(Listener *listener) { listeners.remove(listener); }
 
-    std::unordered_map<String, uint8> indexForColour;
+    // Keyed by packed ARGB.
+    std::unordered_map<uint32, uint8> indexForColour;
 private:
     Array<uint8> availableColourIndexes;
     std::unordered_map<String, uint8> indexForTrackUuid;
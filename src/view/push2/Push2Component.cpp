@@ -1,13 +1,74 @@
 #include "Push2Component.h"
 
 #include "ApplicationPropertiesAndCommandManager.h"
+#include "view/parameter_control/level_meter/MinimalLevelMeter.h"
+
+// Collects the repainted areas, and lets the repaints through to the mirror window (if it's showing),
+// which paints the component as if it had no cached image.
+struct Push2Component::DirtyRegionTracker : public CachedComponentImage {
+    DirtyRegionTracker(Component &component, RectangleList<int> &dirtyRegion) : component(component), dirtyRegion(dirtyRegion) {}
+
+    void paint(Graphics &g) override { component.paintEntireComponent(g, false); }
+    bool invalidateAll() override {
+        dirtyRegion.add({0, 0, Push2Display::WIDTH, Push2Display::HEIGHT});
+        return true;
+    }
+    bool invalidate(const Rectangle<int> &area) override {
+        dirtyRegion.add(area);
+        return true;
+    }
+    void releaseResources() override {}
+
+private:
+    Component &component;
+    RectangleList<int> &dirtyRegion;
+};
+
+// Visible descendants in the order they're painted: each one before its children, and siblings from back to front.
+// With where they are on the display, and the part of them `clip` (the parent's visible bounds on the display) leaves showing.
+template<typename VisibleComponent>
+static void findVisibleComponents(Component &component, juce::Point<int> origin, Rectangle<int> clip, std::vector<VisibleComponent> &found) {
+    // Children are kept in z-order (always-on-top ones last), which is the order they're painted in.
+    for (auto *child : component.getChildren()) {
+        if (!child->isVisible()) continue;
+
+        const auto childOrigin = origin + child->getPosition();
+        const auto childClip = clip.getIntersection(child->getLocalBounds() + childOrigin);
+        if (childClip.isEmpty()) continue;
+
+        found.push_back({child, childOrigin, childClip});
+        findVisibleComponents(*child, childOrigin, childClip, found);
+    }
+}
+
+// The level meters' bars are shared with the main window, so they're drawn into the display from out here.
+// Their thumbs are child components, painted over the bars.
+static void addRasterizers(Push2RasterizerRegistry &rasterizers) {
+    rasterizers.add<Push2Label>([](Push2Label &label) { return label.getRasterizedArea(); },
+                                [](Push2Label &label, Push2Rasterizer &rasterizer, juce::Point<int> origin) { label.rasterize(rasterizer, origin); });
+    rasterizers.add<MinimalLevelMeter>(
+            [](MinimalLevelMeter &meter) {
+                RectangleList<int> area;
+                meter.forEachMeterBar([&area](const Rectangle<int> &barBounds, const Rectangle<int> &) { area.add(barBounds); });
+                return area;
+            },
+            [](MinimalLevelMeter &meter, Push2Rasterizer &rasterizer, juce::Point<int> origin) {
+                const auto background = meter.findColour(LevelMeter::backgroundColourId), foreground = meter.findColour(LevelMeter::foregroundColourId);
+                meter.forEachMeterBar([&](const Rectangle<int> &barBounds, const Rectangle<int> &fillBounds) {
+                    rasterizer.fillRect(barBounds + origin, background);
+                    rasterizer.fillRect(fillBounds + origin, foreground);
+                });
+            });
+}
 
 Push2Component::Push2Component(View &view, Tracks &tracks, Connections &connections, Project &project, StatefulAudioProcessorWrappers &processorWrappers, Push2MidiCommunicator &push2MidiCommunicator)
     : Push2ComponentBase(view, tracks, push2MidiCommunicator),
       project(project), connections(connections), processorWrappers(processorWrappers),
       processorView(view, tracks, project, push2MidiCommunicator), processorSelector(view, tracks, project, push2MidiCommunicator),
       mixerView(view, tracks, project, processorWrappers, push2MidiCommunicator), push2NoteModePadLedManager(tracks, push2MidiCommunicator) {
-    startTimer(60);
+    setCachedComponentImage(new DirtyRegionTracker(*this, dirtyRegion));
+    addRasterizers(rasterizers);
+    startTimerHz(60);
 
     addChildComponent(processorView);
     addChildComponent(processorSelector);
@@ -30,6 +91,7 @@ Push2Component::Push2Component(View &view, Tracks &tracks, Connections &connecti
 
 Push2Component::~Push2Component() {
     setVisible(false);
+    setCachedComponentImage(nullptr);
     project.getUndoManager().removeChangeListener(this);
     view.removeStateListener(this);
     connections.removeStateListener(this);
@@ -157,13 +219,83 @@ void Push2Component::updateEnabledPush2Buttons() {
     }
 }
 
+void Push2Component::setDisplaySink(Push2DisplaySink *displaySink) {
+    displayBridge.setDisplaySink(displaySink);
+    dirtyRegion = RectangleList<int>(getLocalBounds());
+}
+
 void Push2Component::drawFrame() {
     static const juce::Colour CLEAR_COLOR = juce::Colour(0xff000000);
 
+    // LED changes go out together once per frame, whether or not the display is there.
+    push2.flushLedChanges();
+
+    if (!displayBridge.isDisplayConnected()) {
+        // Nothing to draw to. Redraw everything once it's (re)connected.
+        dirtyRegion = RectangleList<int>(getLocalBounds());
+        return;
+    }
+
+    const auto now = Time::getMillisecondCounter();
+    if (dirtyRegion.isEmpty()) {
+        if (now - lastFrameSentMs >= KEEP_ALIVE_INTERVAL_MS) {
+            displayBridge.resendFrameToDisplay();
+            lastFrameSentMs = now;
+        }
+        return;
+    }
+
+    // Anything repainted while painting goes into the next frame.
+    RectangleList<int> region;
+    region.swapWith(dirtyRegion);
+    region.clipTo(getLocalBounds());
+
+    findRasterizedComponents();
+
     auto &g = displayBridge.getGraphics();
-    g.fillAll(CLEAR_COLOR);
-    paintEntireComponent(g, true);
-    displayBridge.writeFrameToDisplay();
+    g.saveState();
+    g.reduceClipRegion(region);
+    // Nothing is painted under what's drawn straight into the display.
+    for (const auto &[component, rasterizer, origin, clip] : rasterizedComponents) {
+        auto area = rasterizer->getRasterizedArea(*component);
+        area.offsetAll(origin);
+        area.clipTo(clip);
+        for (const auto &rectangle : area)
+            g.excludeClipRegion(rectangle);
+    }
+    if (!g.isClipEmpty()) {
+        g.fillAll(CLEAR_COLOR);
+        paintEntireComponent(g, true);
+    }
+    g.restoreState();
+    displayBridge.writeFrameToDisplay(region, [this](Push2Rasterizer &rasterizer) {
+        for (const auto &[component, componentRasterizer, origin, clip] : rasterizedComponents) {
+            for (const auto &rectangle : clip) {
+                rasterizer.setClip(rectangle);
+                componentRasterizer->rasterize(*component, rasterizer, origin);
+            }
+        }
+    });
+    lastFrameSentMs = now;
+}
+
+void Push2Component::findRasterizedComponents() {
+    visibleComponents.clear();
+    rasterizedComponents.clear();
+    findVisibleComponents(*this, {}, getLocalBounds(), visibleComponents);
+    for (size_t i = 0; i < visibleComponents.size(); i++) {
+        const auto &[component, origin, clip] = visibleComponents[i];
+        const auto *rasterizer = rasterizers.find(*component);
+        if (rasterizer == nullptr) continue;
+
+        // Components painted after this one (including its own children) are painted over it, so it's only drawn
+        // into the display where none of them are.
+        RectangleList<int> rasterizedClip(clip);
+        for (size_t j = i + 1; j < visibleComponents.size() && !rasterizedClip.isEmpty(); j++)
+            rasterizedClip.subtract(visibleComponents[j].clip);
+        if (!rasterizedClip.isEmpty())
+            rasterizedComponents.push_back({component, rasterizer, origin, std::move(rasterizedClip)});
+    }
 }
 
 void Push2Component::updatePush2SelectionDependentButtons() {
@@ -2,6 +2,7 @@
 
 #include "push2/Push2MidiCommunicator.h"
 #include "push2/Push2DisplayBridge.h"
+#include "push2/Push2RasterizerRegistry.h"
 #include "Push2ProcessorView.h"
 #include "Push2ProcessorSelector.h"
 #include "Push2MixerView.h"
@@ -42,6 +43,14 @@ public:
     void sessionButtonPressed() override { view.setSessionMode(); }
     void updateEnabledPush2Buttons() override;
 
+    // Render to `displaySink` (not owned) instead of the Push 2 display, or to the Push 2 again if it's `nullptr`.
+    void setDisplaySink(Push2DisplaySink *displaySink);
+
+    // Send the LED changes, render the dirty region and send the frame to the Push 2 display (if it's available).
+    // If nothing changed, only resend the last frame once in a while, to keep the display on.
+    // Called every timer tick, but can also be called directly to render a frame right away.
+    void drawFrame();
+
 private:
     Project &project;
     Connections &connections;
@@ -54,10 +63,34 @@ private:
 
     Push2ComponentBase *currentlyViewingChild{};
 
-    void timerCallback() override { drawFrame(); }
+    // Everything repainted in the component tree since the last frame, collected by its cached image.
+    struct DirtyRegionTracker;
+    RectangleList<int> dirtyRegion;
+    uint32 lastFrameSentMs{0};
+    // The component types drawn straight into the display.
+    Push2RasterizerRegistry rasterizers;
+    // Where a visible component is on the display, and the part of it its ancestors don't hide.
+    struct VisibleComponent {
+        Component *component;
+        juce::Point<int> origin;
+        Rectangle<int> clip;
+    };
+    // Where a component that draws straight into the display is, and the part of it nothing painted later covers.
+    struct RasterizedComponent {
+        Component *component;
+        const Push2RasterizerRegistry::Entry *rasterizer;
+        juce::Point<int> origin;
+        RectangleList<int> clip;
+    };
+    // Found again for every frame.
+    std::vector<VisibleComponent> visibleComponents;
+    std::vector<RasterizedComponent> rasterizedComponents;
+
+    void findRasterizedComponents();
+    // The display goes blank if it doesn't get a frame for 2 seconds.
+    static constexpr uint32 KEEP_ALIVE_INTERVAL_MS = 1000;
 
-    // Render a frame and send it to the Push 2 display (if it's available)
-    void drawFrame();
+    void timerCallback() override { drawFrame(); }
 
     bool canNavigateInDirection(int direction) const;
 
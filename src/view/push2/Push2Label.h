@@ -1,6 +1,7 @@
 #pragma once
 
 #include "push2/Push2MidiCommunicator.h"
+#include "push2/Push2Rasterizer.h"
 
 class Push2Label : public Label {
 public:
@@ -35,6 +36,7 @@ public:
 
     void setUnderlined(bool underlined) {
         this->underlined = underlined;
+        repaint();
     }
 
     void paint(Graphics &g) override {
@@ -45,6 +47,23 @@ public:
         }
     }
 
+    // Same as `paint`, straight into the Push 2 display.
+    RectangleList<int> getRasterizedArea() { return RectangleList<int>(getLocalBounds()); }
+
+    void rasterize(Push2Rasterizer &rasterizer, juce::Point<int> origin) {
+        const auto bounds = getLocalBounds() + origin;
+        const auto &background = findColour(Label::backgroundColourId);
+        rasterizer.fillRect(bounds, background);
+        if (!isBeingEdited()) {
+            auto &lookAndFeel = getLookAndFeel();
+            const auto textArea = lookAndFeel.getLabelBorderSize(*this).subtractedFrom(bounds);
+            rasterizer.drawText(getText(), lookAndFeel.getLabelFont(*this), textArea, getJustificationType(),
+                                findColour(Label::textColourId).withMultipliedAlpha(isEnabled() ? 1.0f : 0.5f), background);
+        }
+        if (underlined)
+            rasterizer.fillRect(bounds.withTop(bounds.getBottom() - 1), colour);
+    }
+
 private:
     int position;
     bool top;
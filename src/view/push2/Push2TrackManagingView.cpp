@@ -5,6 +5,7 @@ Push2TrackManagingView::Push2TrackManagingView(View &view, Tracks &tracks, Proje
     : Push2ComponentBase(view, tracks, push2), project(project) {
     tracks.addChildListener(this);
     view.addListener(this);
+    project.getDragPreview().addChangeListener(this);
 
     for (int i = 0; i < NUM_COLUMNS; i++)
         addChildComponent(trackLabels.add(new Push2Label(i, false, push2)));
@@ -12,6 +13,7 @@ Push2TrackManagingView::Push2TrackManagingView(View &view, Tracks &tracks, Proje
 
 Push2TrackManagingView::~Push2TrackManagingView() {
     push2.getPush2Colours().removeListener(this);
+    project.getDragPreview().removeChangeListener(this);
     view.removeListener(this);
     tracks.removeChildListener(this);
 }
@@ -36,7 +38,8 @@ void Push2TrackManagingView::updateEnabledPush2Buttons() {
 
     if (!isVisible()) return;
 
-    const auto *focusedTrack = tracks.getFocusedTrack();
+    const auto &dragPreview = project.getDragPreview();
+    const int focusedTrackIndex = view.getFocusedTrackAndSlot().x + (dragPreview.isActive() ? dragPreview.getMoveDelta().x : 0);
     int labelIndex = 0;
     for (int i = 0; i < jmin(trackLabels.size(), tracks.getNumNonMasterTracks()); i++) {
         auto *label = trackLabels.getUnchecked(labelIndex++);
@@ -45,7 +48,7 @@ void Push2TrackManagingView::updateEnabledPush2Buttons() {
         label->setVisible(true);
         label->setMainColour(track->getColour());
         label->setText(track->getName(), dontSendNotification);
-        label->setSelected(track == focusedTrack);
+        label->setSelected(track->getIndex() == focusedTrackIndex);
     }
 }
 
@@ -4,7 +4,7 @@
 #include "Push2ComponentBase.h"
 #include "Push2Label.h"
 
-class Push2TrackManagingView : public Push2ComponentBase, protected ValueTree::Listener, protected StatefulList<Track>::Listener {
+class Push2TrackManagingView : public Push2ComponentBase, protected ValueTree::Listener, protected StatefulList<Track>::Listener, private ChangeListener {
 public:
     explicit Push2TrackManagingView(View &view, Tracks &tracks, Project &project, Push2MidiCommunicator &push2);
 
@@ -35,4 +35,7 @@ protected:
 
 private:
     OwnedArray<Push2Label> trackLabels{};
+
+    // The drag preview changed. The focused track label follows the dragged items to the track they'd be dropped in.
+    void changeListenerCallback(ChangeBroadcaster *) override { updateEnabledPush2Buttons(); }
 };